@@ -41,6 +41,9 @@
 #include <algorithm>
 #include <memory>
 #include <functional>
+#include <initializer_list>
+#include <unordered_map>
+#include <optional>
 #include <sstream>
 #include <fstream>
 #include <iostream>
@@ -117,6 +120,165 @@ struct chunk_traits {
 	static constexpr T mask = std::numeric_limits<T>::max();
 };
 
+// Opt-in memoization of the symbolic operations. Most cells see the same inputs cycle after cycle
+// (registers held stable, masks loaded once), a hit returns the previous result instead of building
+// the node and the leakset again. Entries are keyed by the operation and, for each operand, by its
+// node, the identity of its leakset, its concrete state and its stability.
+//
+// Identities are only meaningful while the leaksets are alive, keep() must thus be called before
+// each leaks::clear(). It keeps the leaksets of all entries (computing them in lazy mode) and evicts
+// the entries that were not hit since the previous call once the table is full.
+class op_memo {
+public:
+	enum op : uintptr_t { bit_not, bit_and, bit_or, bit_xor, add, sub, neg, mux, logic_not, logic_and, logic_or };
+
+	struct operand {
+		Node* node;
+		leaks::LeakSet* ls;
+		const chunk_t* data;
+		const chunk_t* stability;
+		size_t chunks;
+	};
+
+	struct stats {
+		uint64_t hits_ = 0;
+		uint64_t misses_ = 0;
+		// Results not stored because the table was full
+		uint64_t dropped_ = 0;
+		uint64_t evicted_ = 0;
+	};
+
+	// A capacity of 0 disables the memoization and drops all entries
+	static void enable(size_t capacity) {
+		memo().capacity_ = capacity;
+		if (capacity == 0)
+			memo().table_.clear();
+	}
+
+	static bool enabled() {
+		return memo().capacity_ > 0;
+	}
+
+	static size_t size() {
+		return memo().table_.size();
+	}
+
+	static const stats& statistics() {
+		return memo().stats_;
+	}
+
+	static bool lookup(op operation, std::initializer_list<operand> operands,
+	                   Node*& node, leaks::LeakSet*& ls, chunk_t* data, chunk_t* stability, size_t chunks) {
+		if (not memoizable(operands))
+			return false;
+		state& m = memo();
+		build_key(operation, operands);
+		auto it = m.table_.find(m.key_);
+		if (it == m.table_.end()) {
+			++m.stats_.misses_;
+			return false;
+		}
+		++m.stats_.hits_;
+		entry& e = it->second;
+		e.used_ = m.epoch_;
+		node = e.node_;
+		ls = e.ls_;
+		std::copy(e.state_.begin(), e.state_.begin() + chunks, data);
+		std::copy(e.state_.begin() + chunks, e.state_.end(), stability);
+		return true;
+	}
+
+	static void store(op operation, std::initializer_list<operand> operands,
+	                  Node* node, leaks::LeakSet* ls, const chunk_t* data, const chunk_t* stability, size_t chunks) {
+		if (not memoizable(operands))
+			return;
+		state& m = memo();
+		if (m.table_.size() >= m.capacity_) {
+			++m.stats_.dropped_;
+			return;
+		}
+		// Operations may be nested, the key of the last lookup is not necessarily this one
+		build_key(operation, operands);
+		entry e{node, ls, std::vector<chunk_t>(data, data + chunks), {}, m.epoch_};
+		e.state_.insert(e.state_.end(), stability, stability + chunks);
+		for (const operand& o : operands)
+			if (o.ls != nullptr)
+				e.inputs_.push_back(o.ls);
+		m.table_.emplace(m.key_, std::move(e));
+	}
+
+	static void keep() {
+		state& m = memo();
+		if (m.table_.size() >= m.capacity_) {
+			m.stats_.evicted_ += std::erase_if(m.table_, [&m](const auto& item) {
+				return item.second.used_ != m.epoch_;
+			});
+		}
+		for (const auto& [key, e] : m.table_) {
+			leaks::keep(e.ls_);
+			for (leaks::LeakSet* input : e.inputs_)
+				leaks::keep(input);
+		}
+		++m.epoch_;
+	}
+
+private:
+	struct entry {
+		Node* node_;
+		leaks::LeakSet* ls_;
+		// Data then stability chunks of the result
+		std::vector<chunk_t> state_;
+		std::vector<leaks::LeakSet*> inputs_;
+		uint32_t used_;
+	};
+
+	struct key_hash {
+		size_t operator()(const std::vector<uintptr_t>& key) const {
+			size_t h = key.size();
+			for (uintptr_t word : key)
+				h ^= std::hash<uintptr_t>{}(word) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+			return h;
+		}
+	};
+
+	struct state {
+		size_t capacity_ = 0;
+		uint32_t epoch_ = 0;
+		std::unordered_map<std::vector<uintptr_t>, entry, key_hash> table_{};
+		// Key of the last lookup or store, reused to avoid an allocation per operation
+		std::vector<uintptr_t> key_{};
+		stats stats_{};
+	};
+
+	static state& memo() {
+		static state m;
+		return m;
+	}
+
+	// Operations on concrete values are cheaper than a lookup
+	static bool memoizable(std::initializer_list<operand> operands) {
+		if (not enabled())
+			return false;
+		for (const operand& o : operands)
+			if (o.node->nature != CONST or o.ls != nullptr)
+				return true;
+		return false;
+	}
+
+	static void build_key(op operation, std::initializer_list<operand> operands) {
+		std::vector<uintptr_t>& key = memo().key_;
+		key.clear();
+		key.push_back(operation);
+		for (const operand& o : operands) {
+			key.push_back(reinterpret_cast<uintptr_t>(o.node));
+			key.push_back(reinterpret_cast<uintptr_t>(o.ls));
+			key.push_back(o.chunks);
+			key.insert(key.end(), o.data, o.data + o.chunks);
+			key.insert(key.end(), o.stability, o.stability + o.chunks);
+		}
+	}
+};
+
 struct leakable {
 	// Previous and curr values of each written cells
 	virtual std::set<std::tuple<size_t, std::pair<Node*, leaks::LeakSet*>, std::pair<Node*, leaks::LeakSet*>>> leak_mem() const = 0;
@@ -272,12 +434,73 @@ struct value : public expr_base<value<Bits>>, leakable {
 		// TODO: Should be done in config so that no recompilation for something this trivial is needed
 		#ifdef MUST_BIT_DECOMPOSE
 		node = &getBitDecomposition(*newNode);
+		leaks::share_bits(node, 0, newNode, 0, Bits);
 		#else
 		node = newNode;
 		#endif
 		ls = leaks::reg_stabilize(node);
 	}
 
+	// Fully concrete values carry no symbolic part nor leakage, operations on them only need the
+	// concrete state and the stability, the lss calls would only build empty leaksets
+	CXXRTL_ALWAYS_INLINE
+	bool is_concrete() const {
+		return node->nature == CONST and ls == nullptr;
+	}
+
+	// Constant node of the concrete state, narrow values are cached by value as they are the most
+	// common ones (selectors, flags, small counters)
+	Node* concrete_node() const {
+		if constexpr (Bits <= 8) {
+			static Node* cache[1 << Bits] = {};
+			Node*& cached = cache[data[0]];
+			if (cached == nullptr)
+				cached = &constant(data[0], Bits);
+			return cached;
+		} else if constexpr (Bits <= 64) {
+			return &constant(get<uint64_t>(), Bits);
+		} else {
+			// Same layout as the constructor, the first chunk is the lsb one
+			Node* res = &constant(data[0], chunk::bits);
+			size_t remainingBits = Bits - chunk::bits;
+			for (size_t n = 1; n < chunks; ++n) {
+				res = &Concat(constant(data[n], (remainingBits > chunk::bits) ? chunk::bits : remainingBits), *res);
+				remainingBits -= chunk::bits;
+			}
+			return res;
+		}
+	}
+
+	CXXRTL_ALWAYS_INLINE
+	op_memo::operand memo_operand() const {
+		return {node, ls, data, stability, chunks};
+	}
+
+	// Memoized result of the operation, if any. The result is only built on a hit so that
+	// operations do not pay for a value they overwrite when the memo is disabled or misses.
+	CXXRTL_ALWAYS_INLINE
+	static std::optional<value<Bits>> memo_lookup(op_memo::op operation, std::initializer_list<op_memo::operand> operands) {
+		if (not op_memo::enabled())
+			return std::nullopt;
+		Node* memo_node;
+		leaks::LeakSet* memo_ls;
+		chunk_t memo_data[chunks];
+		chunk_t memo_stability[chunks];
+		if (not op_memo::lookup(operation, operands, memo_node, memo_ls, memo_data, memo_stability, chunks))
+			return std::nullopt;
+		std::optional<value<Bits>> result{std::in_place};
+		result->node = memo_node;
+		result->ls = memo_ls;
+		std::copy(memo_data, memo_data + chunks, result->data);
+		std::copy(memo_stability, memo_stability + chunks, result->stability);
+		return result;
+	}
+
+	CXXRTL_ALWAYS_INLINE
+	void memo_store(op_memo::op operation, std::initializer_list<op_memo::operand> operands) const {
+		op_memo::store(operation, operands, node, ls, data, stability, chunks);
+	}
+
 	void debug_assert() const {
 		#ifdef DEBUG_STATE_CONSISTANCE
 		if(this->node->nature == CONST) {
@@ -286,7 +509,7 @@ struct value : public expr_base<value<Bits>>, leakable {
 		} else {
 			// Find partially const node that are not consistant with conc state
 			for (size_t i = 0; i < Bits; ++i) {
-				Node* curr = &simplify(Extract(i, i, *(this->node)));
+				Node* curr = leaks::bit(this->node, i);
 				assert(curr->nature != CONST || (((this->data[i/32]) >> (i%32)) & 1) == curr->cst[0]);
 			}
 		}
@@ -309,7 +532,10 @@ struct value : public expr_base<value<Bits>>, leakable {
 	// These operations are used to implement slicing, concatenation, and blitting.
 	// The trunc, zext and sext operations add or remove most significant bits (i.e. on the left);
 	// the rtrunc and rzext operations add or remove least significant bits (i.e. on the right).
-	template<size_t NewBits>
+	//
+	// With Symbolic false, only the concrete state and the stability are computed, for callers that
+	// build the node and the leakset of their result in one step.
+	template<size_t NewBits, bool Symbolic = true>
 	CXXRTL_ALWAYS_INLINE
 	value<NewBits> trunc() const {
 		static_assert(NewBits <= Bits, "trunc() may not increase width");
@@ -321,9 +547,16 @@ struct value : public expr_base<value<Bits>>, leakable {
 		}
 		result.data[result.chunks - 1] &= result.msb_mask;
 		result.stability[result.chunks - 1] &= result.msb_mask;
-
-		if constexpr (NewBits != Bits) {
+		if constexpr (not Symbolic)
+			return result;
+
+		if constexpr (NewBits == 1 and Bits != 1) {
+			// Single bits are looked up in the slices
+			result.node = leaks::bit(node, 0);
+			result.ls = leaks::extract(ls, 0, 0);
+		} else if constexpr (NewBits != Bits) {
 			result.node = &simplify(Extract(NewBits - 1, 0, *node));
+			leaks::share_bits(result.node, 0, node, 0, NewBits);
 			// No partial stab, ls cannot change
 			result.ls = leaks::extract(ls, 0, NewBits - 1);
 		} else {
@@ -335,7 +568,7 @@ struct value : public expr_base<value<Bits>>, leakable {
 		return result;
 	}
 
-	template<size_t NewBits>
+	template<size_t NewBits, bool Symbolic = true>
 	CXXRTL_ALWAYS_INLINE
 	value<NewBits> zext() const {
 		static_assert(NewBits >= Bits, "zext() may not decrease width");
@@ -349,9 +582,12 @@ struct value : public expr_base<value<Bits>>, leakable {
 		for (size_t n = chunks; n < result.chunks; n++)
 			result.stability[n] = chunk::mask;
 		result.stability[result.chunks - 1] &= result.msb_mask;
+		if constexpr (not Symbolic)
+			return result;
 
 		if constexpr (NewBits != Bits) {
 			result.node = &simplify(ZeroExt(NewBits - Bits, *node));
+			leaks::share_bits(result.node, 0, node, 0, Bits);
 			result.ls = leaks::extend(ls, NewBits);
 		} else {
 			result.node = node;
@@ -388,6 +624,7 @@ struct value : public expr_base<value<Bits>>, leakable {
 
 		if constexpr (NewBits != Bits) {
 			result.node = &simplify(SignExt(NewBits - Bits, *node));
+			leaks::share_bits(result.node, 0, node, 0, Bits);
 			result.ls = leaks::sextend(ls, NewBits);
 		} else {
 			result.node = node;
@@ -398,7 +635,7 @@ struct value : public expr_base<value<Bits>>, leakable {
 		return result;
 	}
 
-	template<size_t NewBits>
+	template<size_t NewBits, bool Symbolic = true>
 	CXXRTL_ALWAYS_INLINE
 	value<NewBits> rtrunc() const {
 		static_assert(NewBits <= Bits, "rtrunc() may not increase width");
@@ -421,9 +658,15 @@ struct value : public expr_base<value<Bits>>, leakable {
 			carryStab = (shift_bits == 0) ? 0
 				: stability[shift_chunks + n - 1] << (chunk::bits - shift_bits);
 		}
+		if constexpr (not Symbolic)
+			return result;
 
-		if constexpr (NewBits != Bits) {
+		if constexpr (NewBits == 1 and Bits != 1) {
+			result.node = leaks::bit(node, Bits - 1);
+			result.ls = leaks::extract(ls, Bits - 1, Bits - 1);
+		} else if constexpr (NewBits != Bits) {
 			result.node = &simplify(Extract(Bits - 1, Bits - NewBits, *node));
+			leaks::share_bits(result.node, 0, node, Bits - NewBits, NewBits);
 			// No partial stab as it cannot change the ls
 			result.ls = leaks::extract(ls, Bits - NewBits, Bits - 1);
 		} else {
@@ -435,7 +678,7 @@ struct value : public expr_base<value<Bits>>, leakable {
 		return result;
 	}
 
-	template<size_t NewBits>
+	template<size_t NewBits, bool Symbolic = true>
 	CXXRTL_ALWAYS_INLINE
 	value<NewBits> rzext() const {
 		static_assert(NewBits >= Bits, "rzext() may not decrease width");
@@ -463,9 +706,12 @@ struct value : public expr_base<value<Bits>>, leakable {
 			result.stability[n] = chunk::mask;
 		if (shift_bits > 0)
 			result.stability[shift_chunks] |= (chunk::mask >> (chunk::bits - shift_bits));
+		if constexpr (not Symbolic)
+			return result;
 
 		if constexpr (NewBits != Bits) {
 			result.node = &simplify(Concat(*node, constant(0, NewBits - Bits)));
+			leaks::share_bits(result.node, NewBits - Bits, node, 0, Bits);
 			result.ls = leaks::rextend(ls, NewBits);
 		} else {
 			result.node = node;
@@ -533,6 +779,9 @@ struct value : public expr_base<value<Bits>>, leakable {
 		} else {
 			res.node = &simplify(Concat(Extract(Bits - 1, Stop + 1, *node), *source.node, Extract(Start - 1, 0, *node)));
 		}
+		leaks::share_bits(res.node, 0, node, 0, Start);
+		leaks::share_bits(res.node, Start, source.node, 0, Stop - Start + 1);
+		leaks::share_bits(res.node, Stop + 1, node, Stop + 1, Bits - Stop - 1);
 
 
 		for (size_t n = 0; n < chunks; n++) {
@@ -608,6 +857,8 @@ struct value : public expr_base<value<Bits>>, leakable {
 
 		std::vector<Node*> concatNodes(Bits * Count, node);
 		res.node = &Concat(concatNodes);
+		for (size_t i = 0; i < Count; ++i)
+			leaks::share_bits(res.node, i, node, 0, 1);
 		// No need to apply partial stabilisation as if the bit was stable, it has already been stabilised
 		res.ls = leaks::replicate(ls, Bits * Count);
 		res.debug_assert();
@@ -768,6 +1019,8 @@ struct value : public expr_base<value<Bits>>, leakable {
 	}
 
 	value<Bits> bit_not() const {
+		if (auto memoized = memo_lookup(op_memo::bit_not, {memo_operand()}))
+			return *memoized;
 		value<Bits> result;
 		for (size_t n = 0; n < chunks; n++) {
 			result.data[n] = ~data[n];
@@ -776,13 +1029,22 @@ struct value : public expr_base<value<Bits>>, leakable {
 		result.data[chunks - 1] &= msb_mask;
 		result.stability[chunks - 1] &= msb_mask;
 
+		if (is_concrete()) {
+			result.node = result.concrete_node();
+			result.debug_assert();
+			return result;
+		}
+
 		result.node = &simplify(~*node);
 		result.ls = leaks::partial_stabilize(ls, result.node, result.stability);
+		result.memo_store(op_memo::bit_not, {memo_operand()});
 		result.debug_assert();
 		return result;
 	}
 
 	value<Bits> bit_and(const value<Bits> &other) const {
+		if (auto memoized = memo_lookup(op_memo::bit_and, {memo_operand(), other.memo_operand()}))
+			return *memoized;
 		value<Bits> result;
 		for (size_t n = 0; n < chunks; n++) {
 			result.data[n] = data[n] & other.data[n];
@@ -794,6 +1056,13 @@ struct value : public expr_base<value<Bits>>, leakable {
 				result.stability[n] |= (other.stability[n] & ~other.data[n]);
 		}
 
+		if (is_concrete() and other.is_concrete()) {
+			result.stability[chunks - 1] &= msb_mask;
+			result.node = result.concrete_node();
+			result.debug_assert();
+			return result;
+		}
+
 		// Absorbing elements for partially const values
 		if (node->nature != CONST or other.node->nature != CONST) {
 			for (size_t n = 0; n < chunks; n++) {
@@ -805,11 +1074,11 @@ struct value : public expr_base<value<Bits>>, leakable {
 					// If there is stability for this bit, split the node and check if it is const and
 					// aborbant
 					if (this->stability[n] & (0x1 << i)) {
-						Node* na = &simplify(Extract(bit, bit, *this->node));
+						Node* na = leaks::bit(this->node, bit);
 						stab |= static_cast<chunk_t>(na->nature == CONST and na->cst[0] == 0x0u) << i;
 					}
 					if (other.stability[n] & (0x1 << i)) {
-						Node* nb = &simplify(Extract(bit, bit, *other.node));
+						Node* nb = leaks::bit(other.node, bit);
 						stab |= static_cast<chunk_t>(nb->nature == CONST and nb->cst[0] == 0x0u) << i;
 					}
 				}
@@ -820,11 +1089,14 @@ struct value : public expr_base<value<Bits>>, leakable {
 
 		result.node = &simplify(*node & *other.node);
 		result.ls = leaks::partial_stabilize(leaks::merge(ls, other.ls), result.node, result.stability);
+		result.memo_store(op_memo::bit_and, {memo_operand(), other.memo_operand()});
 		result.debug_assert();
 		return result;
 	}
 
 	value<Bits> bit_or(const value<Bits> &other) const {
+		if (auto memoized = memo_lookup(op_memo::bit_or, {memo_operand(), other.memo_operand()}))
+			return *memoized;
 		value<Bits> result;
 		for (size_t n = 0; n < chunks; n++) {
 			result.data[n] = data[n] | other.data[n];
@@ -836,6 +1108,13 @@ struct value : public expr_base<value<Bits>>, leakable {
 				result.stability[n] |= (other.stability[n] & other.data[n]);
 		}
 
+		if (is_concrete() and other.is_concrete()) {
+			result.stability[chunks - 1] &= msb_mask;
+			result.node = result.concrete_node();
+			result.debug_assert();
+			return result;
+		}
+
 		// Absorbing elements for partially const values
 		if (node->nature != CONST or other.node->nature != CONST) {
 			for (size_t n = 0; n < chunks; n++) {
@@ -847,11 +1126,11 @@ struct value : public expr_base<value<Bits>>, leakable {
 					// If there is stability for this bit, split the node and check if it is const and
 					// aborbant
 					if (this->stability[n] & (0x1 << i)) {
-						Node* na = &simplify(Extract(bit, bit, *this->node));
+						Node* na = leaks::bit(this->node, bit);
 						stab |= static_cast<chunk_t>(na->nature == CONST and na->cst[0] == 0x1u) << i;
 					}
 					if (other.stability[n] & (0x1 << i)) {
-						Node* nb = &simplify(Extract(bit, bit, *other.node));
+						Node* nb = leaks::bit(other.node, bit);
 						stab |= static_cast<chunk_t>(nb->nature == CONST and nb->cst[0] == 0x1u) << i;
 					}
 				}
@@ -862,19 +1141,29 @@ struct value : public expr_base<value<Bits>>, leakable {
 
 		result.node = &simplify(*node | *other.node);
 		result.ls = leaks::partial_stabilize(leaks::merge(ls, other.ls), result.node, result.stability);
+		result.memo_store(op_memo::bit_or, {memo_operand(), other.memo_operand()});
 		result.debug_assert();
 		return result;
 	}
 
 	value<Bits> bit_xor(const value<Bits> &other) const {
+		if (auto memoized = memo_lookup(op_memo::bit_xor, {memo_operand(), other.memo_operand()}))
+			return *memoized;
 		value<Bits> result;
 		for (size_t n = 0; n < chunks; n++) {
 			result.data[n] = data[n] ^ other.data[n];
 			result.stability[n] = (stability[n] & other.stability[n]);
 		}
 
+		if (is_concrete() and other.is_concrete()) {
+			result.node = result.concrete_node();
+			result.debug_assert();
+			return result;
+		}
+
 		result.node = &simplify(*node ^ *other.node);
 		result.ls = leaks::partial_stabilize(leaks::merge(ls, other.ls), result.node, result.stability);
+		result.memo_store(op_memo::bit_xor, {memo_operand(), other.memo_operand()});
 		result.debug_assert();
 		return result;
 	}
@@ -1083,43 +1372,73 @@ struct value : public expr_base<value<Bits>>, leakable {
 	}
 
 	value<Bits> add(const value<Bits> &other) const {
+		if (auto memoized = memo_lookup(op_memo::add, {memo_operand(), other.memo_operand()}))
+			return *memoized;
 		value<Bits> result = alu</*Invert=*/false, /*CarryIn=*/false>(other).first;
-		result.node = &simplify(*node + *other.node);
 
 		// Replicate full stability on output only if both inputs are fully stable
 		if (is_fully_stable() && other.is_fully_stable())
 			std::copy(stability, stability + value<Bits>::chunks, result.stability);
 
+		if (is_concrete() and other.is_concrete()) {
+			result.node = result.concrete_node();
+			result.debug_assert();
+			return result;
+		}
+
+		result.node = &simplify(*node + *other.node);
+
 		result.ls = leaks::partial_stabilize(leaks::mix(ls, other.ls), result.node, result.stability);
+		result.memo_store(op_memo::add, {memo_operand(), other.memo_operand()});
 
 		result.debug_assert();
 		return result;
 	}
 
 	value<Bits> sub(const value<Bits> &other) const {
+		if (auto memoized = memo_lookup(op_memo::sub, {memo_operand(), other.memo_operand()}))
+			return *memoized;
 		value<Bits> result = alu</*Invert=*/true, /*CarryIn=*/true>(other).first;
-		result.node = &simplify(*node - *other.node);
 
 		// Replicate full stability on output only if both inputs are fully stable
 		if (is_fully_stable() && other.is_fully_stable())
 			std::copy(stability, stability + value<Bits>::chunks, result.stability);
 
+		if (is_concrete() and other.is_concrete()) {
+			result.node = result.concrete_node();
+			result.debug_assert();
+			return result;
+		}
+
+		result.node = &simplify(*node - *other.node);
+
 		result.ls = leaks::partial_stabilize(leaks::mix(ls, other.ls), result.node, result.stability);
+		result.memo_store(op_memo::sub, {memo_operand(), other.memo_operand()});
 
 		result.debug_assert();
 		return result;
 	}
 
 	value<Bits> neg() const {
+		if (auto memoized = memo_lookup(op_memo::neg, {memo_operand()}))
+			return *memoized;
 		value<Bits> result = value<Bits>().sub(*this);
-		result.node = &simplify(- *node);
 
 		// Replicate full stability on output only if input is fully stable
 		// TODO: We could do better, in case node is CONST
 		if (is_fully_stable())
 			std::copy(stability, stability + value<Bits>::chunks, result.stability);
 
+		// The sub already took the concrete path and set the node
+		if (is_concrete()) {
+			result.debug_assert();
+			return result;
+		}
+
+		result.node = &simplify(- *node);
+
 		result.ls = leaks::partial_stabilize(leaks::mix(ls, nullptr), result.node, result.stability);
+		result.memo_store(op_memo::neg, {memo_operand()});
 
 		result.debug_assert();
 		return result;
@@ -1231,11 +1550,28 @@ struct slice_expr : public expr_base<slice_expr<T, Stop, Start>> {
 	slice_expr(T &expr) : expr(expr) {}
 	slice_expr(const slice_expr<T, Stop, Start> &) = delete;
 
+	// The node and the leakset are built in a single step, single bits are looked up in the slices
 	CXXRTL_ALWAYS_INLINE
 	operator value<bits>() const {
-		return static_cast<const value<T::bits> &>(expr)
-			.template rtrunc<T::bits - Start>()
-			.template trunc<bits>();
+		const value<T::bits> &source = expr;
+		value<bits> result = source
+			.template rtrunc<T::bits - Start, false>()
+			.template trunc<bits, false>();
+		if constexpr (bits == T::bits) {
+			result.node = source.node;
+			result.ls = source.ls;
+		} else if (source.is_concrete()) {
+			result.node = result.concrete_node();
+		} else if constexpr (bits == 1) {
+			result.node = leaks::bit(source.node, Start);
+			result.ls = leaks::extract(source.ls, Start, Stop);
+		} else {
+			result.node = &simplify(Extract(Stop, Start, *source.node));
+			leaks::share_bits(result.node, 0, source.node, Start, bits);
+			result.ls = leaks::extract(source.ls, Start, Stop);
+		}
+		result.debug_assert();
+		return result;
 	}
 
 	CXXRTL_ALWAYS_INLINE
@@ -1264,13 +1600,32 @@ struct concat_expr : public expr_base<concat_expr<T, U>> {
 	concat_expr(T &ms_expr, U &ls_expr) : ms_expr(ms_expr), ls_expr(ls_expr) {}
 	concat_expr(const concat_expr<T, U> &) = delete;
 
+	// Bits are only moved: the concrete parts are shifted in place, the node and the leakset are
+	// built once from both parts and the node takes their known slices
 	CXXRTL_ALWAYS_INLINE
 	operator value<bits>() const {
-		value<bits> ms_shifted = static_cast<const value<T::bits> &>(ms_expr)
-			.template rzext<bits>();
-		value<bits> ls_extended = static_cast<const value<U::bits> &>(ls_expr)
-			.template zext<bits>();
-		return ms_shifted.bit_or(ls_extended);
+		const value<T::bits> &ms = ms_expr;
+		const value<U::bits> &ls = ls_expr;
+		value<bits> result = ms.template rzext<bits, false>();
+		value<bits> ls_extended = ls.template zext<bits, false>();
+		for (size_t n = 0; n < result.chunks; n++) {
+			result.data[n] |= ls_extended.data[n];
+			result.stability[n] &= ls_extended.stability[n];
+		}
+
+		if (ms.is_concrete() and ls.is_concrete()) {
+			result.node = result.concrete_node();
+			result.debug_assert();
+			return result;
+		}
+
+		result.node = &simplify(Concat(*ms.node, *ls.node));
+		leaks::share_bits(result.node, 0, ls.node, 0, U::bits);
+		leaks::share_bits(result.node, U::bits, ms.node, 0, T::bits);
+		// No partial stab, moving bits cannot change the ls
+		result.ls = leaks::concat({{ls.ls, U::bits}, {ms.ls, T::bits}});
+		result.debug_assert();
+		return result;
 	}
 
 	CXXRTL_ALWAYS_INLINE
@@ -1364,6 +1719,10 @@ struct wire : public leakable {
 
 	value<Bits> curr;
 	value<Bits> next;
+	// Leakset of curr pinned by the last symb_keep()
+	leaks::LeakSet* pinned = nullptr;
+	// Nodes of the last commit, whose leakset is curr.ls
+	std::pair<Node*, Node*> committed{nullptr, nullptr};
 
 	wire() = default;
 	explicit constexpr wire(const value<Bits> &init) : curr(init), next(init) {}
@@ -1430,7 +1789,7 @@ struct wire : public leakable {
 						size_t bit = (n * value<Bits>::chunk::bits) + i;
 						if (bit >= Bits)
 							break;
-						stab |= static_cast<chunk_t>(&simplify(Extract(bit, bit, *next.node)) == &simplify(Extract(bit, bit, *curr.node))) << i;
+						stab |= static_cast<chunk_t>(leaks::bit(next.node, bit) == leaks::bit(curr.node, bit)) << i;
 					}
 					next.stability[n] = stab;
 				}
@@ -1445,8 +1804,14 @@ struct wire : public leakable {
 		//	return true;
 		//}
 
-		// TODO: There is a useless ls created here
-		next.ls = leaks::merge(leaks::reg_stabilize(curr.node), leaks::reg_stabilize(next.node));
+		// Only computed if read, by the Manager or by a downstream operation. A register that holds
+		// its nodes commits the same leakset every cycle, which stays pinned and computed once.
+		if (committed == std::pair(curr.node, next.node)) {
+			next.ls = curr.ls;
+		} else {
+			next.ls = leaks::reg_commit(curr.node, next.node);
+			committed = {curr.node, next.node};
+		}
 		curr = next;
 
 		#ifdef MUST_BIT_DECOMPOSE
@@ -1458,9 +1823,14 @@ struct wire : public leakable {
 	}
 
 	// We keep current node in any cases and next one only if it is an (input/output/constant/...)
+	// The current leakset stays pinned until it changes, most of them do not change every cycle
 	void symb_keep(bool toBeKept) {
 		next.symb_keep(toBeKept);
-		curr.symb_keep(true);
+		if (curr.ls != pinned) {
+			leaks::unpin(pinned);
+			leaks::pin(curr.ls);
+			pinned = curr.ls;
+		}
 	}
 };
 
@@ -1477,6 +1847,9 @@ struct memory : public leakable {
 	std::vector<std::tuple<size_t, size_t, std::function<cxxrtl::value<Width>&(cxxrtl::value<Width>&)>>> funcArrays;
 	const size_t depth;
 	std::unique_ptr<value<Width>[]> data;
+	// Leaksets pinned by symb_keep() per written index, and the indexes committed since then
+	std::unordered_map<size_t, leaks::LeakSet*> pinned;
+	std::vector<size_t> dirty;
 	std::pair<Node*, leaks::LeakSet*> leak_single() const {
 		assert(false && "Memory should be accessed via mem.");
 		return {data[0].node, data[0].ls};
@@ -1506,6 +1879,8 @@ struct memory : public leakable {
 		assert(depth == other.depth);
 		data = std::move(other.data);
 		write_queue = std::move(other.write_queue);
+		pinned = std::move(other.pinned);
+		dirty = std::move(other.dirty);
 		return *this;
 	}
 
@@ -1625,17 +2000,25 @@ struct memory : public leakable {
 				changed |= true;
 			}
 			data[entry.index] = elem_up;
+			dirty.push_back(entry.index);
 			elem_up.debug_assert();
 		}
 		write_queue.clear();
 		return changed;
 	}
 
-	// Nothing to clear here, we just keep the leaksets of all ls in memory
+	// Nothing to clear here, the leaksets of the written indexes stay pinned, only those committed
+	// since the last call may have changed
 	void symb_keep() {
-		for (auto& index : written) {
-			data[index].symb_keep(true);
+		for (size_t index : dirty) {
+			leaks::LeakSet*& index_pinned = pinned[index];
+			if (data[index].ls != index_pinned) {
+				leaks::unpin(index_pinned);
+				leaks::pin(data[index].ls);
+				index_pinned = data[index].ls;
+			}
 		}
+		dirty.clear();
 	}
 };
 
@@ -2399,7 +2782,21 @@ template<size_t BitsY>
 CXXRTL_ALWAYS_INLINE
 value<BitsY> symb_mux(const value<1>& sel, const value<BitsY>& b, const value<BitsY>& c) {
 	// Here the stability is also copied, we later erase it if the selector is not stable
+	if (auto memoized = value<BitsY>::memo_lookup(op_memo::mux, {sel.memo_operand(), b.memo_operand(), c.memo_operand()}))
+		return *memoized;
 	value<BitsY> res = (!sel.Concis_zero() ? b : c); // It is ok to use concis_zero because we handeled this concretisation
+
+	// Fully concrete mux, only the stability may change, there is no leakage to propagate
+	if (sel.is_concrete() and b.is_concrete() and c.is_concrete()) {
+		if (sel.stability[0] == 0x0u) {
+			for (size_t i = 0; i < res.chunks; i++)
+				res.stability[i] = ~(b.data[i] ^ c.data[i]) & b.stability[i] & c.stability[i];
+			res.stability[res.chunks-1] &= res.msb_mask;
+		}
+		res.debug_assert();
+		return res;
+	}
+
 	if (sel.node->nature != CONST) {
 		simulation_logger << "Fixed: Muxing on a non conc selector, preventing concretisation." << std::endl;
 		value<BitsY> maskSelector = sel.repeat<BitsY>();
@@ -2436,7 +2833,7 @@ value<BitsY> symb_mux(const value<1>& sel, const value<BitsY>& b, const value<Bi
 					size_t bit = (n * value<BitsY>::chunk::bits) + i;
 					if (bit >= value<BitsY>::bits)
 						break;
-					stab |= static_cast<chunk_t>((b.stability[n] & c.stability[n] & (0x1 << i)) and &simplify(Extract(bit, bit, *b.node)) == &simplify(Extract(bit, bit, *c.node))) << i;
+					stab |= static_cast<chunk_t>((b.stability[n] & c.stability[n] & (0x1 << i)) and leaks::bit(b.node, bit) == leaks::bit(c.node, bit)) << i;
 				}
 				res.stability[n] = stab;
 			}
@@ -2447,6 +2844,7 @@ value<BitsY> symb_mux(const value<1>& sel, const value<BitsY>& b, const value<Bi
 	}
 
 	// If selector is stable, conc and has no leakset, mux is just a passthrough
+	res.memo_store(op_memo::mux, {sel.memo_operand(), b.memo_operand(), c.memo_operand()});
 	res.debug_assert();
 	return res;
 }
@@ -2463,14 +2861,16 @@ template<size_t BitsY, size_t BitsA>
 CXXRTL_ALWAYS_INLINE
 value<BitsY> logic_not(const value<BitsA> &a) {
 	static_assert(BitsY == 1);
+	if (auto memoized = value<BitsY>::memo_lookup(op_memo::logic_not, {a.memo_operand()}))
+		return *memoized;
 	value<BitsY> tmp = value<BitsY> { a.Concis_zero() ? 1u : 0u };
 
 	// If any bit equals to one, result is 0. So, reduce_or then not the result
 	if (a.node->nature != CONST) {
 		simulation_logger << "Fixed: logic_not: Will comp to 0" << std::endl;
-		Node* res = &simplify(Extract(0, 0, *a.node));
+		Node* res = leaks::bit(a.node, 0);
 		for (int i = 1; i < a.node->width; i++) {
-			res = &simplify(*res | Extract(i, i, *a.node));
+			res = &simplify(*res | *leaks::bit(a.node, i));
 			// We got a conc counter-example, we can conclude now (a bit was const and equal to one so result is const 0)
 			if (res->nature == CONST and res->cst[0] == 0x1u)
 				break;
@@ -2495,7 +2895,7 @@ value<BitsY> logic_not(const value<BitsA> &a) {
 				if (bit >= BitsA)
 					break;
 				if (a.stability[n] & (0x1 << i)) {
-					Node* na = &simplify(Extract(bit, bit, *a.node));
+					Node* na = leaks::bit(a.node, bit);
 					if (na->nature == CONST and na->cst[0] == 0x1u) {
 						stable = true;
 						break;
@@ -2513,6 +2913,7 @@ value<BitsY> logic_not(const value<BitsA> &a) {
 		tmp.ls = leaks::partial_stabilize(leaks::reduce(a.ls), tmp.node, tmp.stability);
 	}
 
+	tmp.memo_store(op_memo::logic_not, {a.memo_operand()});
 	tmp.debug_assert();
 	return tmp;
 }
@@ -2521,6 +2922,8 @@ template<size_t BitsY, size_t BitsA, size_t BitsB>
 CXXRTL_ALWAYS_INLINE
 value<BitsY> logic_and(const value<BitsA> &a, const value<BitsB> &b) {
 	static_assert(BitsY == 1 and BitsA == BitsB);
+	if (auto memoized = value<BitsY>::memo_lookup(op_memo::logic_and, {a.memo_operand(), b.memo_operand()}))
+		return *memoized;
 	value<BitsY> tmp = value<BitsY> { (not a.Concis_zero() && not b.Concis_zero()) ? 1u : 0u };
 
 	// If either is not a constant, compute node
@@ -2528,12 +2931,12 @@ value<BitsY> logic_and(const value<BitsA> &a, const value<BitsB> &b) {
 		simulation_logger << "Fixed: logic_and: Will comp to 0" << std::endl;
 
 		// logic and is the bitwise and between the reduce_or of operands a and b
-		Node* resa = &simplify(Extract(0, 0, *a.node));
-		Node* resb = &simplify(Extract(0, 0, *b.node));
+		Node* resa = leaks::bit(a.node, 0);
+		Node* resb = leaks::bit(b.node, 0);
 		// We asserted that they are the same size
 		for (size_t i = 1; i < BitsA; i++) {
-			resa = &simplify(*resa | Extract(i, i, *a.node));
-			resb = &simplify(*resb | Extract(i, i, *b.node));
+			resa = &simplify(*resa | *leaks::bit(a.node, i));
+			resb = &simplify(*resb | *leaks::bit(b.node, i));
 			// If both temporarly computed results are const and equal to one, the result will be 0 (after the not) so stop
 			if (resa->nature == CONST and resa->cst[0] == 0x1u and resb->nature == CONST and resb->cst[0] == 0x1u)
 				break;
@@ -2568,7 +2971,7 @@ value<BitsY> logic_and(const value<BitsA> &a, const value<BitsB> &b) {
 				if (bit >= BitsA)
 					break;
 				if (a.stability[n] & (0x1 << i)) {
-					Node* na = &simplify(Extract(bit, bit, *a.node));
+					Node* na = leaks::bit(a.node, bit);
 					if (na->nature == CONST and na->cst[0] == 0x1u) {
 						stableA = true;
 						break;
@@ -2584,7 +2987,7 @@ value<BitsY> logic_and(const value<BitsA> &a, const value<BitsB> &b) {
 				if (bit >= BitsB)
 					break;
 				if (b.stability[n] & (0x1 << i)) {
-					Node* nb = &simplify(Extract(bit, bit, *b.node));
+					Node* nb = leaks::bit(b.node, bit);
 					if (nb->nature == CONST and nb->cst[0] == 0x1u) {
 						stableB = true;
 						break;
@@ -2603,6 +3006,7 @@ value<BitsY> logic_and(const value<BitsA> &a, const value<BitsB> &b) {
 		tmp.ls = leaks::partial_stabilize(leaks::reduce_and_merge(a.ls, b.ls), tmp.node, tmp.stability);
 	}
 
+	tmp.memo_store(op_memo::logic_and, {a.memo_operand(), b.memo_operand()});
 	tmp.debug_assert();
 	return tmp;
 }
@@ -2611,18 +3015,20 @@ template<size_t BitsY, size_t BitsA, size_t BitsB>
 CXXRTL_ALWAYS_INLINE
 value<BitsY> logic_or(const value<BitsA> &a, const value<BitsB> &b) {
 	static_assert(BitsY == 1 and BitsA == BitsB);
+	if (auto memoized = value<BitsY>::memo_lookup(op_memo::logic_or, {a.memo_operand(), b.memo_operand()}))
+		return *memoized;
 	value<BitsY> tmp = value<BitsY> { (not a.Concis_zero() || not b.Concis_zero()) ? 1u : 0u };
 
 	// logic and is the bitwise and between the reduce_or of operands a and b
 	if (a.node->nature != CONST or b.node->nature != CONST) {
 		simulation_logger << "Fixed: logic_or: Will comp to 0" << std::endl;
 
-		Node* resa = &simplify(Extract(0, 0, *a.node));
-		Node* resb = &simplify(Extract(0, 0, *b.node));
+		Node* resa = leaks::bit(a.node, 0);
+		Node* resb = leaks::bit(b.node, 0);
 		// Size is equal, it was asserted
 		for (size_t i = 1; i < BitsA; i++) {
-			resa = &simplify(*resa | Extract(i, i, *a.node));
-			resb = &simplify(*resb | Extract(i, i, *b.node));
+			resa = &simplify(*resa | *leaks::bit(a.node, i));
+			resb = &simplify(*resb | *leaks::bit(b.node, i));
 			// If either of the temporarly computed results is const and equal to one, the result will be 1 so stop
 			if ((resa->nature == CONST and resa->cst[0] == 0x1u) or (resb->nature == CONST and resb->cst[0] == 0x1u))
 				break;
@@ -2656,7 +3062,7 @@ value<BitsY> logic_or(const value<BitsA> &a, const value<BitsB> &b) {
 				if (bit >= BitsA)
 					break;
 				if (a.stability[n] & (0x1 << i)) {
-					Node* na = &simplify(Extract(bit, bit, *a.node));
+					Node* na = leaks::bit(a.node, bit);
 					if (na->nature == CONST and na->cst[0] == 0x1u) {
 						stable = true;
 						break;
@@ -2672,7 +3078,7 @@ value<BitsY> logic_or(const value<BitsA> &a, const value<BitsB> &b) {
 				if (bit >= BitsB)
 					break;
 				if (b.stability[n] & (0x1 << i)) {
-					Node* nb = &simplify(Extract(bit, bit, *b.node));
+					Node* nb = leaks::bit(b.node, bit);
 					if (nb->nature == CONST and nb->cst[0] == 0x1u) {
 						stable = true;
 						break;
@@ -2690,6 +3096,7 @@ value<BitsY> logic_or(const value<BitsA> &a, const value<BitsB> &b) {
 		tmp.ls = leaks::partial_stabilize(leaks::reduce_and_merge(a.ls, b.ls), tmp.node, tmp.stability);
 	}
 
+	tmp.memo_store(op_memo::logic_or, {a.memo_operand(), b.memo_operand()});
 	tmp.debug_assert();
 	return tmp;
 }
@@ -2703,9 +3110,9 @@ value<BitsY> reduce_and(const value<BitsA> &a) {
 
 	if (a.node->nature != CONST) {
 		simulation_logger << "Fixed: reduce_and: Will comp to 0" << std::endl;
-		Node* res = &simplify(Extract(0, 0, *a.node));
+		Node* res = leaks::bit(a.node, 0);
 		for (int i = 1; i < a.node->width; i++) {
-			res = &simplify(*res & Extract(i, i, *a.node));
+			res = &simplify(*res & *leaks::bit(a.node, i));
 			// If we find a bit that is const and equals 0, the and will be 0 so skip
 			if (res->nature == CONST and res->cst[0] == 0x0u)
 				break;
@@ -2731,7 +3138,7 @@ value<BitsY> reduce_and(const value<BitsA> &a) {
 				if (bit >= BitsA)
 					break;
 				if (a.stability[n] & (0x1 << i)) {
-					Node* na = &simplify(Extract(bit, bit, *a.node));
+					Node* na = leaks::bit(a.node, bit);
 					if (na->nature == CONST and na->cst[0] == 0x0u) {
 						stable = true;
 						break;
@@ -2761,9 +3168,9 @@ value<BitsY> reduce_or(const value<BitsA> &a) {
 
 	if (a.node->nature != CONST) {
 		simulation_logger << "Fixed: reduce_or: Will comp to 0" << std::endl;
-		Node* res = &simplify(Extract(0, 0, *a.node));
+		Node* res = leaks::bit(a.node, 0);
 		for (int i = 1; i < a.node->width; i++) {
-			res = &simplify(*res | Extract(i, i, *a.node));
+			res = &simplify(*res | *leaks::bit(a.node, i));
 			// If we find a bit that is const and equals 1, the and will be 1 so skip
 			if (res->nature == CONST and res->cst[0] == 0x1u)
 				break;
@@ -2789,7 +3196,7 @@ value<BitsY> reduce_or(const value<BitsA> &a) {
 				if (bit >= BitsA)
 					break;
 				if (a.stability[n] & (0x1 << i)) {
-					Node* na = &simplify(Extract(bit, bit, *a.node));
+					Node* na = leaks::bit(a.node, bit);
 					if (na->nature == CONST and na->cst[0] == 0x1u) {
 						stable = true;
 						break;
@@ -2848,9 +3255,9 @@ value<BitsY> reduce_bool(const value<BitsA> &a) {
 
 	if (a.node->nature != CONST) {
 		simulation_logger << "Fixed: reduce_bool: Will comp to 0" << std::endl;
-		Node* res = &simplify(Extract(0, 0, *a.node));
+		Node* res = leaks::bit(a.node, 0);
 		for (int i = 1; i < a.node->width; i++) {
-			res = &simplify(*res | Extract(i, i, *a.node));
+			res = &simplify(*res | *leaks::bit(a.node, i));
 			// If we find a bit that is const and equals 1, the and will be 1 so skip
 			if (res->nature == CONST and res->cst[0] == 0x1u)
 				break;
@@ -2876,7 +3283,7 @@ value<BitsY> reduce_bool(const value<BitsA> &a) {
 				if (bit >= BitsA)
 					break;
 				if (a.stability[n] & (0x1 << i)) {
-					Node* na = &simplify(Extract(bit, bit, *a.node));
+					Node* na = leaks::bit(a.node, bit);
 					if (na->nature == CONST and na->cst[0] == 0x1u) {
 						stable = true;
 						break;
@@ -3070,9 +3477,9 @@ value<BitsY> eq_uu(const value<BitsA> &a, const value<BitsB> &b) {
 	if (a.node->nature != CONST || b.node->nature != CONST) {
 		simulation_logger << "Fixed: eq_uu: Will ==" << std::endl;
 		Node* xorc = &simplify((*ea.node) ^ (*eb.node));
-		Node* res = &simplify(Extract(0, 0, *xorc));
+		Node* res = leaks::bit(xorc, 0);
 		for (size_t i = 1; i < BitsExt; i++) {
-			res = &simplify(*res | Extract(i, i, *xorc));
+			res = &simplify(*res | *leaks::bit(xorc, i));
 			// If we find a bit that is const and equal to 1 (it means we found two bits that are const and different), skip the rest result will be 0
 			if (res->nature == CONST and res->cst[0] == 0x1u)
 				break;
@@ -3098,8 +3505,8 @@ value<BitsY> eq_uu(const value<BitsA> &a, const value<BitsB> &b) {
 				if (bit >= BitsExt)
 					break;
 				if (a.stability[n] & b.stability[n] & (0x1 << i)) {
-					Node* na = &simplify(Extract(bit, bit, *ea.node));
-					Node* nb = &simplify(Extract(bit, bit, *eb.node));
+					Node* na = leaks::bit(ea.node, bit);
+					Node* nb = leaks::bit(eb.node, bit);
 					if (na->nature == CONST and nb->nature == CONST and na->cst[0] != nb->cst[0]) {
 						stable = true;
 						break;
@@ -3165,9 +3572,9 @@ value<BitsY> ne_uu(const value<BitsA> &a, const value<BitsB> &b) {
 	if (a.node->nature != CONST || b.node->nature != CONST) {
 		simulation_logger << "Fixed: ne_uu: Will ==" << std::endl;
 		Node* xorc = &simplify((*ea.node) ^ (*eb.node));
-		Node* res = &simplify(Extract(0, 0, *xorc));
+		Node* res = leaks::bit(xorc, 0);
 		for (size_t i = 1; i < BitsExt; i++) {
-			res = &simplify(*res | Extract(i, i, *xorc));
+			res = &simplify(*res | *leaks::bit(xorc, i));
 			// If we find a bit that is const and equal to 1 (it means we found two bits that are const and different), skip the rest result will be 1
 			if (res->nature == CONST and res->cst[0] == 0x1u)
 				break;
@@ -3193,8 +3600,8 @@ value<BitsY> ne_uu(const value<BitsA> &a, const value<BitsB> &b) {
 				if (bit >= BitsExt)
 					break;
 				if (a.stability[n] & b.stability[n] & (0x1 << i)) {
-					Node* na = &simplify(Extract(bit, bit, *ea.node));
-					Node* nb = &simplify(Extract(bit, bit, *eb.node));
+					Node* na = leaks::bit(ea.node, bit);
+					Node* nb = leaks::bit(eb.node, bit);
 					if (na->nature == CONST and nb->nature == CONST and na->cst[0] != nb->cst[0]) {
 						stable = true;
 						break;
@@ -3287,10 +3694,10 @@ value<BitsY> gt_uu(const value<BitsA> &a, const value<BitsB> &b) {
 		Node* res = &simplify((Extract(BitsExt - 1, BitsExt - 1, *ea.node)) & (~Extract(BitsExt - 1, BitsExt - 1, *eb.node)));
 		for (int i = BitsExt - 2; i >= 0; i--) {
 			//simulation_logger << "i: " << i << std::endl;
-			Node* layer = &simplify((Extract(i, i, *ea.node)) & (~Extract(i, i, *eb.node)));
+			Node* layer = &simplify((*leaks::bit(ea.node, i)) & (~*leaks::bit(eb.node, i)));
 			for (int j = BitsExt - 1; i < j; j--) { // Starting from layer 1 is important
 				//simulation_logger << "i: " << i << ", j: " << j << std::endl;
-				layer = &simplify(*layer & ~((Extract(j, j, *ea.node)) ^ (Extract(j, j, *eb.node))));
+				layer = &simplify(*layer & ~((*leaks::bit(ea.node, j)) ^ (*leaks::bit(eb.node, j))));
 			}
 			res = &simplify(*res | *layer);
 		}
@@ -3331,10 +3738,10 @@ value<BitsY> gt_ss(const value<BitsA> &a, const value<BitsB> &b) {
 			res = &simplify((Extract(BitsExt - 2, BitsExt - 2, *ea.node)) & (~Extract(BitsExt - 2, BitsExt - 2, *eb.node)));
 			for (int i = BitsExt - 3; i >= 0; i--) {
 				//simulation_logger << "i: " << i << std::endl;
-				Node* layer = &simplify((Extract(i, i, *ea.node)) & (~Extract(i, i, *eb.node)));
+				Node* layer = &simplify((*leaks::bit(ea.node, i)) & (~*leaks::bit(eb.node, i)));
 				for (int j = BitsExt - 1; i < j; j--) { // Starting from layer 1 is important
 					//simulation_logger << "i: " << i << ", j: " << j << std::endl;
-					layer = &simplify(*layer & ~((Extract(j, j, *ea.node)) ^ (Extract(j, j, *eb.node))));
+					layer = &simplify(*layer & ~((*leaks::bit(ea.node, j)) ^ (*leaks::bit(eb.node, j))));
 				}
 				res = &simplify(*res | *layer);
 			}
@@ -3373,10 +3780,10 @@ value<BitsY> lt_uu(const value<BitsA> &a, const value<BitsB> &b) {
 		Node* res = &simplify((~Extract(BitsExt - 1, BitsExt - 1, *ea.node)) & (Extract(BitsExt - 1, BitsExt - 1, *eb.node)));
 		for (int i = BitsExt - 2; i >= 0; i--) {
 			//simulation_logger << "i: " << i << std::endl;
-			Node* layer = &simplify((~Extract(i, i, *ea.node)) & (Extract(i, i, *eb.node)));
+			Node* layer = &simplify((~*leaks::bit(ea.node, i)) & (*leaks::bit(eb.node, i)));
 			for (int j = BitsExt - 1; i < j; j--) {
 				//simulation_logger << "i: " << i << ", j: " << j << std::endl;
-				layer = &simplify(*layer & ~((Extract(j, j, *ea.node)) ^ (Extract(j, j, *eb.node))));
+				layer = &simplify(*layer & ~((*leaks::bit(ea.node, j)) ^ (*leaks::bit(eb.node, j))));
 			}
 			res = &simplify(*res | *layer);
 		}
@@ -3416,10 +3823,10 @@ value<BitsY> lt_ss(const value<BitsA> &a, const value<BitsB> &b) {
 			res = &simplify((~Extract(BitsExt - 2, BitsExt - 2, *ea.node)) & (Extract(BitsExt - 2, BitsExt - 2, *eb.node)));
 			for (int i = BitsExt - 3; i >= 0; i--) {
 				//simulation_logger << "i: " << i << std::endl;
-				Node* layer = &simplify((~Extract(i, i, *ea.node)) & (Extract(i, i, *eb.node)));
+				Node* layer = &simplify((~*leaks::bit(ea.node, i)) & (*leaks::bit(eb.node, i)));
 				for (int j = BitsExt - 1; i < j; j--) { // Starting from layer 1 is important
 					//simulation_logger << "i: " << i << ", j: " << j << std::endl;
-					layer = &simplify(*layer & ~((Extract(j, j, *ea.node)) ^ (Extract(j, j, *eb.node))));
+					layer = &simplify(*layer & ~((*leaks::bit(ea.node, j)) ^ (*leaks::bit(eb.node, j))));
 				}
 				res = &simplify(*res | *layer);
 			}
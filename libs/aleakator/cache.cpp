@@ -0,0 +1,482 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "cache.h"
+
+// Finalizer of splitmix64
+static uint64_t mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// Two independent order dependent chains
+static void absorb(uint64_t& high, uint64_t& low, uint64_t value) {
+    high = mix(high ^ value);
+    low = mix(low + value * 0xff51afd7ed558ccdULL) ^ (low >> 17);
+}
+
+// std::set iterates nodes in pointer order
+Fingerprint fingerprint(const std::set<Node*>& set) {
+    uint64_t high = 0x9e3779b97f4a7c15ULL ^ set.size();
+    uint64_t low = 0xc2b2ae3d27d4eb4fULL + set.size();
+    for (Node* node : set)
+        absorb(high, low, reinterpret_cast<uintptr_t>(node));
+    return {high, low};
+}
+
+Fingerprint fingerprint(const std::vector<uint64_t>& words) {
+    uint64_t high = 0x9e3779b97f4a7c15ULL ^ words.size();
+    uint64_t low = 0xc2b2ae3d27d4eb4fULL + words.size();
+    for (uint64_t word : words)
+        absorb(high, low, word);
+    return {high, low};
+}
+
+Fingerprint fingerprint(std::string_view text) {
+    uint64_t high = 0x9e3779b97f4a7c15ULL ^ text.size();
+    uint64_t low = 0xc2b2ae3d27d4eb4fULL + text.size();
+    for (size_t i = 0; i < text.size(); i += 8) {
+        uint64_t word = 0;
+        std::memcpy(&word, text.data() + i, std::min<size_t>(8, text.size() - i));
+        absorb(high, low, word);
+    }
+    return {high, low};
+}
+
+SetVerdicts::SetVerdicts(bool exact) : exact_(exact), slots_(1024), sets_(exact ? 1024 : 0) {}
+
+// Linear probing, returns the slot of the fingerprint or the empty slot where it would go
+size_t SetVerdicts::probe(const Fingerprint& fingerprint) const {
+    size_t mask = slots_.size() - 1;
+    size_t index = fingerprint.low_ & mask;
+    while (slots_[index].state_ != EMPTY and slots_[index].fingerprint_ != fingerprint)
+        index = (index + 1) & mask;
+    return index;
+}
+
+void SetVerdicts::grow() {
+    std::vector<Slot> slots(slots_.size() * 2);
+    std::vector<std::set<Node*>> sets(exact_ ? slots.size() : 0);
+    std::swap(slots, slots_);
+    std::swap(sets, sets_);
+
+    for (size_t i = 0; i < slots.size(); ++i) {
+        if (slots[i].state_ == EMPTY)
+            continue;
+        size_t index = this->probe(slots[i].fingerprint_);
+        slots_[index] = slots[i];
+        if (exact_)
+            sets_[index] = std::move(sets[i]);
+    }
+}
+
+const bool* SetVerdicts::find(const std::set<Node*>& set) const {
+    static constexpr bool verdicts[2] = {false, true};
+
+    size_t index = this->probe(fingerprint(set));
+    if (slots_[index].state_ == EMPTY)
+        return nullptr;
+    // A fingerprint collision is considered as a miss, the set will then replace the stored one
+    if (exact_ and sets_[index] != set)
+        return nullptr;
+    return &verdicts[slots_[index].state_ == SECURE];
+}
+
+void SetVerdicts::insert(const std::set<Node*>& set, bool is_secure) {
+    // Keep load factor under 0.5 for short probe sequences
+    if (2 * (used_ + 1) > slots_.size())
+        this->grow();
+
+    Fingerprint key = fingerprint(set);
+    size_t index = this->probe(key);
+    if (slots_[index].state_ == EMPTY)
+        ++used_;
+    slots_[index] = {key, is_secure ? SECURE : LEAKING};
+    if (exact_)
+        sets_[index] = set;
+}
+
+template<typename T>
+static uint64_t field_word(const T& field) {
+    if constexpr (std::is_convertible_v<const T&, std::string_view>)
+        return fingerprint(std::string_view(field)).low_;
+    else
+        return static_cast<uint64_t>(field);
+}
+
+// Key of a node from its printed expression and what the print may not show: other programs
+// sharing the verdicts may use the same symbol names with other types or widths
+static Fingerprint printed_key(const Node* node) {
+    Fingerprint printed = fingerprint(node->verbatimPrint());
+    uint64_t type = (node->nature == SYMB) ? static_cast<uint64_t>(node->symbType) : 0;
+    return fingerprint(std::vector<uint64_t>{static_cast<uint64_t>(node->nature), static_cast<uint64_t>(node->width), type,
+        printed.high_, printed.low_});
+}
+
+// Key of a node whose children keys are known, templated so that the fields are only looked up
+// when they exist
+template<typename N>
+static Fingerprint local_key(const N* node, const std::unordered_map<const N*, Fingerprint>& node_keys) {
+    if (node->children.empty())
+        return printed_key(node);
+
+    if constexpr (OperationFields<N>) {
+        std::vector<uint64_t> words{static_cast<uint64_t>(node->nature), static_cast<uint64_t>(node->width),
+            field_word(node->op), field_word(node->msb), field_word(node->lsb)};
+        for (const Node* child : node->children) {
+            const Fingerprint& key = node_keys.at(child);
+            words.push_back(key.high_);
+            words.push_back(key.low_);
+        }
+        return fingerprint(words);
+    } else {
+        return printed_key(node);
+    }
+}
+
+// Expressions may be very deep, the traversal uses an explicit stack
+const Fingerprint& StructuralKeys::structural_key(const Node* root) {
+    if (const auto& search = node_keys_.find(root); search != node_keys_.end())
+        return search->second;
+
+    // The printed expression covers the operations of the whole sub-expression, its distinct leaves
+    // add their types and widths in the order they are first met
+    if constexpr (not OperationFields<Node>) {
+        Fingerprint key = printed_key(root);
+        std::vector<uint64_t> words{key.high_, key.low_};
+        std::unordered_set<const Node*> visited{root};
+        std::vector<const Node*> stack{root};
+        while (not stack.empty()) {
+            const Node* node = stack.back();
+            stack.pop_back();
+            if (node->children.empty()) {
+                Fingerprint leaf = printed_key(node);
+                words.push_back(leaf.high_);
+                words.push_back(leaf.low_);
+            }
+            for (auto child = node->children.rbegin(); child != node->children.rend(); ++child)
+                if (visited.insert(*child).second)
+                    stack.push_back(*child);
+        }
+        return node_keys_.emplace(root, fingerprint(words)).first->second;
+    }
+
+    std::vector<std::pair<const Node*, size_t>> stack{{root, 0}};
+    while (not stack.empty()) {
+        const Node* node = stack.back().first;
+        size_t next = stack.back().second;
+        if (next < node->children.size()) {
+            ++stack.back().second;
+            const Node* child = node->children[next];
+            if (not node_keys_.contains(child))
+                stack.push_back({child, 0});
+            continue;
+        }
+        stack.pop_back();
+        // Shared sub-expressions may have been pushed several times
+        if (not node_keys_.contains(node))
+            node_keys_.emplace(node, local_key(node, node_keys_));
+    }
+
+    return node_keys_.at(root);
+}
+
+Fingerprint StructuralKeys::node_key(Node* node) {
+    const Fingerprint& key = this->structural_key(node);
+    return fingerprint(std::vector<uint64_t>{salt_, 'N', key.high_, key.low_});
+}
+
+Fingerprint StructuralKeys::set_key(const std::set<Node*>& set) {
+    // Pointer order is not structural, sort on the keys of the nodes instead
+    std::vector<Fingerprint> keys;
+    keys.reserve(set.size());
+    for (Node* node : set)
+        keys.push_back(this->structural_key(node));
+    std::ranges::sort(keys, {}, [](const Fingerprint& key) { return std::pair(key.high_, key.low_); });
+
+    std::vector<uint64_t> words{salt_, 'S'};
+    for (const auto& key : keys) {
+        words.push_back(key.high_);
+        words.push_back(key.low_);
+    }
+    return fingerprint(words);
+}
+
+// A superset contains every node of the set, candidates are the sets of its rarest node
+bool SubsumptionIndex::has_superset(const std::vector<uint32_t>& atoms) const {
+    const std::vector<uint32_t>* candidates = nullptr;
+    for (uint32_t atom : atoms)
+        if (candidates == nullptr or secure_.postings_[atom].size() < candidates->size())
+            candidates = &secure_.postings_[atom];
+
+    for (uint32_t index : *candidates)
+        if (std::ranges::includes(secure_.sets_[index], atoms))
+            return true;
+    return false;
+}
+
+// A subset is found once all its nodes have been counted
+bool SubsumptionIndex::has_subset(const std::vector<uint32_t>& atoms) const {
+    std::unordered_map<uint32_t, size_t> counts;
+    for (uint32_t atom : atoms)
+        for (uint32_t index : leaking_.postings_[atom])
+            if (++counts[index] == leaking_.sets_[index].size())
+                return true;
+    return false;
+}
+
+std::optional<bool> SubsumptionIndex::find(const std::set<Node*>& set, bool counted) {
+    // Unknown nodes are in no stored set, they rule out supersets only
+    std::vector<uint32_t> atoms;
+    atoms.reserve(set.size());
+    bool all_known = true;
+    for (Node* node : set) {
+        if (const auto& search = atoms_.find(node); search != atoms_.end())
+            atoms.push_back(search->second);
+        else
+            all_known = false;
+    }
+    std::ranges::sort(atoms);
+
+    if (atoms.empty())
+        return std::nullopt;
+    if (all_known and this->has_superset(atoms)) {
+        hits_ += counted;
+        return true;
+    }
+    if (this->has_subset(atoms)) {
+        hits_ += counted;
+        return false;
+    }
+    return std::nullopt;
+}
+
+void SubsumptionIndex::insert(const std::set<Node*>& set, bool is_secure) {
+    if (set.empty())
+        return;
+
+    std::vector<uint32_t> atoms;
+    atoms.reserve(set.size());
+    for (Node* node : set) {
+        auto [it, inserted] = atoms_.try_emplace(node, static_cast<uint32_t>(atoms_.size()));
+        if (inserted) {
+            secure_.postings_.emplace_back();
+            leaking_.postings_.emplace_back();
+        }
+        atoms.push_back(it->second);
+    }
+    std::ranges::sort(atoms);
+
+    Verdicts& verdicts = (is_secure) ? secure_ : leaking_;
+    uint32_t index = static_cast<uint32_t>(verdicts.sets_.size());
+    for (uint32_t atom : atoms)
+        verdicts.postings_[atom].push_back(index);
+    verdicts.sets_.push_back(std::move(atoms));
+}
+
+// Records are the two fingerprint words followed by the verdict byte
+static constexpr size_t record_size = 2 * sizeof(uint64_t) + 1;
+
+PersistentVerdicts::PersistentVerdicts(const std::filesystem::path& path) : path_(path) {
+    std::ifstream file(path_, std::ios::binary);
+    std::string content{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+
+    // A truncated last record (interrupted run) is ignored
+    for (size_t offset = 0; offset + record_size <= content.size(); offset += record_size) {
+        Fingerprint key;
+        std::memcpy(&key.high_, content.data() + offset, sizeof(uint64_t));
+        std::memcpy(&key.low_, content.data() + offset + sizeof(uint64_t), sizeof(uint64_t));
+        verdicts_[key] = content[offset + 2 * sizeof(uint64_t)] != 0;
+    }
+    loaded_ = verdicts_.size();
+}
+
+const bool* PersistentVerdicts::find(const Fingerprint& key) {
+    if (const auto& search = verdicts_.find(key); search != verdicts_.end()) {
+        ++hits_;
+        return &search->second;
+    }
+    return nullptr;
+}
+
+void PersistentVerdicts::insert(const Fingerprint& key, bool is_secure) {
+    if (const auto& [it, inserted] = verdicts_.try_emplace(key, is_secure); inserted or it->second != is_secure) {
+        it->second = is_secure;
+        unsaved_.push_back({key, is_secure});
+    }
+}
+
+// Records are appended with a single write so that runs sharing the file do not interleave them
+void PersistentVerdicts::flush() {
+    if (unsaved_.empty())
+        return;
+
+    std::string buffer(unsaved_.size() * record_size, '\0');
+    for (size_t i = 0; i < unsaved_.size(); ++i) {
+        char* record = buffer.data() + i * record_size;
+        std::memcpy(record, &unsaved_[i].first.high_, sizeof(uint64_t));
+        std::memcpy(record + sizeof(uint64_t), &unsaved_[i].first.low_, sizeof(uint64_t));
+        record[2 * sizeof(uint64_t)] = unsaved_[i].second ? 1 : 0;
+    }
+
+    int fd = open(path_.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0 or write(fd, buffer.data(), buffer.size()) != static_cast<ssize_t>(buffer.size()))
+        std::cerr << "Could not save verdicts to " << path_ << std::endl;
+    if (fd >= 0)
+        close(fd);
+    unsaved_.clear();
+}
+
+// The header is followed by the slots, the file starts zeroed which is an empty table
+struct alignas(64) SharedVerdicts::Header {
+    uint64_t magic_;
+    uint64_t slots_;
+    // Insertion counter, gives the age of slots
+    std::atomic<uint64_t> clock_;
+};
+
+struct SharedVerdicts::Slot {
+    // Odd while the slot is written
+    std::atomic<uint64_t> sequence_;
+    std::atomic<uint64_t> high_;
+    std::atomic<uint64_t> low_;
+    // Insertion stamp, then a used bit and the verdict bit
+    std::atomic<uint64_t> info_;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared verdicts need lock free atomics");
+
+static constexpr uint64_t shared_magic = 0x3130'5444'5256'4b4cULL; // "LKRVDT01"
+static constexpr size_t bucket_slots = 4;
+static constexpr uint64_t slot_used = 2;
+static constexpr uint64_t slot_secure = 1;
+
+SharedVerdicts::SharedVerdicts(const std::filesystem::path& path, size_t slots) {
+    slots = std::max(bucket_slots, (slots + bucket_slots - 1) / bucket_slots * bucket_slots);
+
+    int fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+        throw std::runtime_error( "Could not open shared cache " + path.string() + "." );
+
+    // Processes attaching at the same time must agree on the size, only the setup is locked
+    flock(fd, LOCK_EX);
+    struct stat status;
+    Header header{};
+    bool valid = fstat(fd, &status) == 0;
+    if (valid and status.st_size == 0) {
+        header.magic_ = shared_magic;
+        header.slots_ = slots;
+        valid = ftruncate(fd, sizeof(Header) + slots * sizeof(Slot)) == 0
+            and pwrite(fd, &header, 2 * sizeof(uint64_t), 0) == 2 * sizeof(uint64_t);
+    } else if (valid) {
+        valid = pread(fd, &header, 2 * sizeof(uint64_t), 0) == 2 * sizeof(uint64_t)
+            and header.magic_ == shared_magic
+            and static_cast<size_t>(status.st_size) == sizeof(Header) + header.slots_ * sizeof(Slot);
+    }
+
+    void* mapping = MAP_FAILED;
+    if (valid) {
+        mapping_size_ = sizeof(Header) + header.slots_ * sizeof(Slot);
+        mapping = mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    flock(fd, LOCK_UN);
+    // The mapping stays valid once the file is closed
+    close(fd);
+
+    if (not valid)
+        throw std::runtime_error( "Shared cache " + path.string() + " is not a verdict table." );
+    if (mapping == MAP_FAILED)
+        throw std::runtime_error( "Could not map shared cache " + path.string() + "." );
+
+    header_ = static_cast<Header*>(mapping);
+    slots_ = reinterpret_cast<Slot*>(header_ + 1);
+    buckets_ = header.slots_ / bucket_slots;
+}
+
+SharedVerdicts::~SharedVerdicts() {
+    munmap(header_, mapping_size_);
+}
+
+size_t SharedVerdicts::capacity() const {
+    return buckets_ * bucket_slots;
+}
+
+std::optional<bool> SharedVerdicts::find(const Fingerprint& key) {
+    Slot* bucket = slots_ + (key.low_ % buckets_) * bucket_slots;
+    for (size_t i = 0; i < bucket_slots; ++i) {
+        Slot& slot = bucket[i];
+        uint64_t sequence = slot.sequence_.load(std::memory_order_acquire);
+        if (sequence & 1)
+            continue;
+        uint64_t high = slot.high_.load(std::memory_order_relaxed);
+        uint64_t low = slot.low_.load(std::memory_order_relaxed);
+        uint64_t info = slot.info_.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence_.load(std::memory_order_relaxed) != sequence)
+            continue;
+
+        if ((info & slot_used) and high == key.high_ and low == key.low_) {
+            ++hits_;
+            return (info & slot_secure) != 0;
+        }
+    }
+    return std::nullopt;
+}
+
+void SharedVerdicts::insert(const Fingerprint& key, bool is_secure) {
+    uint64_t stamp = header_->clock_.fetch_add(1, std::memory_order_relaxed) + 1;
+
+    // Same key first, then a free slot, then the oldest one. Values read here may be stale, they
+    // only guide the choice of the slot.
+    Slot* bucket = slots_ + (key.low_ % buckets_) * bucket_slots;
+    Slot* victim = nullptr;
+    uint64_t oldest = std::numeric_limits<uint64_t>::max();
+    for (size_t i = 0; i < bucket_slots; ++i) {
+        uint64_t info = bucket[i].info_.load(std::memory_order_relaxed);
+        if (not (info & slot_used) or (bucket[i].high_.load(std::memory_order_relaxed) == key.high_
+            and bucket[i].low_.load(std::memory_order_relaxed) == key.low_)) {
+            victim = &bucket[i];
+            break;
+        }
+        if ((info >> 2) < oldest) {
+            oldest = info >> 2;
+            victim = &bucket[i];
+        }
+    }
+
+    uint64_t sequence = victim->sequence_.load(std::memory_order_relaxed);
+    if ((sequence & 1) or not victim->sequence_.compare_exchange_strong(sequence, sequence + 1, std::memory_order_acquire))
+        return;
+    std::atomic_thread_fence(std::memory_order_release);
+
+    uint64_t info = victim->info_.load(std::memory_order_relaxed);
+    if ((info & slot_used) and (victim->high_.load(std::memory_order_relaxed) != key.high_
+        or victim->low_.load(std::memory_order_relaxed) != key.low_))
+        ++evictions_;
+
+    victim->high_.store(key.high_, std::memory_order_relaxed);
+    victim->low_.store(key.low_, std::memory_order_relaxed);
+    victim->info_.store((stamp << 2) | slot_used | (is_secure ? slot_secure : 0), std::memory_order_relaxed);
+    victim->sequence_.store(sequence + 2, std::memory_order_release);
+}
@@ -0,0 +1,413 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "verif_msi_pp.hpp"
+#include "support.h"
+
+// 128 bits fingerprint of a set of nodes, computed over the sorted node pointers
+struct Fingerprint {
+    uint64_t high_;
+    uint64_t low_;
+
+    bool operator==(const Fingerprint& other) const = default;
+};
+
+struct FingerprintHash {
+    size_t operator()(const Fingerprint& fingerprint) const { return fingerprint.low_; }
+};
+
+Fingerprint fingerprint(const std::set<Node*>& set);
+Fingerprint fingerprint(const std::vector<uint64_t>& words);
+Fingerprint fingerprint(std::string_view text);
+
+// Open addressing table of set verdicts keyed by fingerprint. Sets themselves are only stored when
+// exact verification is requested, a hit is then confirmed by comparing the sets.
+class SetVerdicts {
+    private:
+        enum SlotState : uint8_t { EMPTY, SECURE, LEAKING };
+        struct Slot {
+            Fingerprint fingerprint_{0, 0};
+            SlotState state_ = EMPTY;
+        };
+
+        const bool exact_;
+        std::vector<Slot> slots_;
+        std::vector<std::set<Node*>> sets_;
+        size_t used_ = 0;
+
+        size_t probe(const Fingerprint& fingerprint) const;
+        void grow();
+
+    public:
+        explicit SetVerdicts(bool exact);
+
+        // Returns nullptr if the set is not in the table, the verdict otherwise
+        const bool* find(const std::set<Node*>& set) const;
+        void insert(const std::set<Node*>& set, bool is_secure);
+        size_t size() const { return used_; }
+};
+
+// Operation nodes expose what tells them apart beyond their nature, width and children in the
+// versions of verif_msi_pp that have these fields
+template<typename N>
+concept OperationFields = requires(const N& node) {
+    node.op;
+    node.msb;
+    node.lsb;
+};
+
+// Keys that do not depend on the addresses of nodes, thus valid in other processes: a node is
+// identified by its structure, a set by the sorted keys of its nodes. The salt identifies the
+// configuration the verdicts are valid for.
+// Node keys are memoized and combine the keys of the children, leaves are identified by their
+// nature, width, symbol type and printed expression. Without OperationFields, nodes are identified
+// by their printed expression and the keys of their distinct leaves.
+class StructuralKeys {
+    private:
+        const uint64_t salt_;
+        std::unordered_map<const Node*, Fingerprint> node_keys_{};
+
+        const Fingerprint& structural_key(const Node* node);
+
+    public:
+        explicit StructuralKeys(uint64_t salt) : salt_(salt) {}
+
+        Fingerprint node_key(Node* node);
+        Fingerprint set_key(const std::set<Node*>& set);
+};
+
+// Verdicts kept in a file across runs, by structural keys. New verdicts are appended to the file
+// by flush(), several runs may share the same file.
+class PersistentVerdicts {
+    private:
+        const std::filesystem::path path_;
+        std::unordered_map<Fingerprint, bool, FingerprintHash> verdicts_{};
+        std::vector<std::pair<Fingerprint, bool>> unsaved_{};
+
+        unsigned int loaded_ = 0;
+        unsigned int hits_ = 0;
+
+    public:
+        explicit PersistentVerdicts(const std::filesystem::path& path);
+
+        // Returns nullptr if the key is unknown, the verdict otherwise
+        const bool* find(const Fingerprint& key);
+        void insert(const Fingerprint& key, bool is_secure);
+        void flush();
+
+        unsigned int get_loaded() const { return loaded_; }
+        unsigned int get_hits() const { return hits_; }
+};
+
+// Verdicts shared by the aLEAKator processes of a host through a memory mapped file, by structural
+// keys. The table has a fixed number of slots grouped in small buckets, a full bucket evicts its
+// oldest verdict. Nothing is locked once the table is mapped: each slot carries a sequence number
+// that is odd while the slot is written, readers treat a slot changing under them as a miss and
+// writers give up on a slot already being written. Losing a verdict this way is always safe.
+class SharedVerdicts {
+    private:
+        struct Header;
+        struct Slot;
+
+        Header* header_ = nullptr;
+        Slot* slots_ = nullptr;
+        size_t mapping_size_ = 0;
+        size_t buckets_ = 0;
+
+        unsigned int hits_ = 0;
+        unsigned int evictions_ = 0;
+
+    public:
+        // The number of slots is only used when the file is created, an existing table keeps its size
+        SharedVerdicts(const std::filesystem::path& path, size_t slots);
+        ~SharedVerdicts();
+        SharedVerdicts(const SharedVerdicts&) = delete;
+        SharedVerdicts& operator=(const SharedVerdicts&) = delete;
+
+        std::optional<bool> find(const Fingerprint& key);
+        void insert(const Fingerprint& key, bool is_secure);
+
+        size_t capacity() const;
+        unsigned int get_hits() const { return hits_; }
+        unsigned int get_evictions() const { return evictions_; }
+};
+
+// Glitch set verdicts indexed for subsumption. Observing fewer nodes cannot reveal more, so a set is
+// secure when a known secure set contains it and leaking when it contains a known leaking set. This
+// holds for TPS and NI, not for SNI whose bound depends on the observation. Nodes are interned in
+// dense identifiers, each identifier lists the stored sets it belongs to.
+class SubsumptionIndex {
+    private:
+        struct Verdicts {
+            // Sorted identifiers of the nodes of each set
+            std::vector<std::vector<uint32_t>> sets_{};
+            std::vector<std::vector<uint32_t>> postings_{};
+        };
+
+        std::unordered_map<Node*, uint32_t> atoms_{};
+        Verdicts secure_{};
+        Verdicts leaking_{};
+
+        unsigned int hits_ = 0;
+
+        bool has_superset(const std::vector<uint32_t>& atoms) const;
+        bool has_subset(const std::vector<uint32_t>& atoms) const;
+
+    public:
+        // Hits are not accounted when counted is false
+        std::optional<bool> find(const std::set<Node*>& set, bool counted = true);
+        void insert(const std::set<Node*>& set, bool is_secure);
+
+        unsigned int get_hits() const { return hits_; }
+};
+
+// Verdicts that depend on the number of share occurrences allowed by ni(), which is the order minus
+// the number of outputs for SNI. Being secure with a bound implies being secure with any greater
+// bound, leaking implies leaking with any smaller one: one interval per key answers every bound.
+struct BoundedVerdict {
+    int secure_from_ = std::numeric_limits<int>::max();
+    int leaking_up_to_ = std::numeric_limits<int>::min();
+
+    bool known(int bound) const { return bound >= secure_from_ or bound <= leaking_up_to_; }
+    bool is_secure(int bound) const { return bound >= secure_from_; }
+    void record(int bound, bool is_secure) {
+        if (is_secure)
+            secure_from_ = std::min(secure_from_, bound);
+        else
+            leaking_up_to_ = std::max(leaking_up_to_, bound);
+    }
+};
+
+// Simple helper class for cache that should be inlined
+class Cache {
+    private:
+        std::map<Node*, bool> verified_nodes_{};
+        SetVerdicts verified_sets_;
+        // Sets are only kept to confirm fingerprint hits when exact verification is requested
+        const bool exact_sets_;
+        std::map<Node*, BoundedVerdict> bounded_nodes_{};
+        std::unordered_map<Fingerprint, std::pair<std::set<Node*>, BoundedVerdict>, FingerprintHash> bounded_sets_{};
+        // Consulted on misses only, verdicts found there are copied in memory
+        std::unique_ptr<StructuralKeys> keys_{};
+        std::unique_ptr<PersistentVerdicts> persistent_{};
+        std::unique_ptr<SharedVerdicts> shared_{};
+        // Consulted after every other cache, verdicts found there are copied in memory
+        std::unique_ptr<SubsumptionIndex> subsumption_{};
+        // Expressions without secret are trivially secure when set
+        std::unique_ptr<SupportTable> supports_{};
+
+        unsigned int cache_hit_node_ = 0;
+        unsigned int cache_hit_set_ = 0;
+        unsigned int cache_miss_set_ = 0;
+
+        unsigned int trivial_nodes_skipped_ = 0;
+        unsigned int trivial_sets_skipped_ = 0;
+
+    public:
+        struct CacheVerdict {
+            bool in_cache_ = false;
+            bool is_secure_ = true;
+        };
+        // Lookup statistics, forked workers send back what they added to theirs
+        struct Counters {
+            unsigned int hits_nodes_ = 0;
+            unsigned int hits_sets_ = 0;
+            unsigned int misses_sets_ = 0;
+            unsigned int trivial_nodes_ = 0;
+            unsigned int trivial_sets_ = 0;
+        };
+
+        explicit Cache(bool exact_sets = false) : verified_sets_(exact_sets), exact_sets_(exact_sets) {}
+
+        // Verdicts outside of this process need structural keys, salted with the configuration
+        void use_structural_keys(uint64_t salt) { keys_ = std::make_unique<StructuralKeys>(salt); }
+        void persist_to(const std::filesystem::path& path) {
+            assert(keys_ && "Structural keys are needed to persist verdicts");
+            persistent_ = std::make_unique<PersistentVerdicts>(path);
+        }
+        void share_through(const std::filesystem::path& path, size_t slots) {
+            assert(keys_ && "Structural keys are needed to share verdicts");
+            shared_ = std::make_unique<SharedVerdicts>(path, slots);
+        }
+        // Only valid for properties where observing a subset cannot reveal more
+        void use_subsumption() { subsumption_ = std::make_unique<SubsumptionIndex>(); }
+        const SubsumptionIndex* subsumption() const { return subsumption_.get(); }
+        // Only valid for properties where an expression without secret cannot leak
+        void use_secret_support() { supports_ = std::make_unique<SupportTable>(); }
+        SupportTable* supports() { return supports_.get(); }
+        const PersistentVerdicts* persistent() const { return persistent_.get(); }
+        const SharedVerdicts* shared() const { return shared_.get(); }
+        void flush() {
+            if (persistent_)
+                persistent_->flush();
+        }
+
+        bool is_node_trivial(Node* node) {
+            return (node->nature == CONST) or (supports_ and not supports_->has_secret(node));
+        }
+        CacheVerdict is_cached_node_secure(Node* node) {
+            // If following is true, it is in cache
+            if (const auto& search = verified_nodes_.find(node); search != verified_nodes_.end()) {
+                ++cache_hit_node_;
+                return {true, search->second};
+            } else if (this->load_node(node)) {
+                ++cache_hit_node_;
+                return {true, verified_nodes_[node]};
+            } else {
+                return {false, true};
+            }
+        }
+        // Lookup that is not accounted in statistics
+        bool contains_node(Node* node) { return verified_nodes_.contains(node) or this->load_node(node); }
+
+        bool is_set_trivial(const std::set<Node*>& set) {
+            if (set.size() == 0)
+                return true;
+            if (not supports_)
+                return false;
+            return std::ranges::none_of(set, [&](Node* node) { return supports_->has_secret(node); });
+        }
+        CacheVerdict is_cached_set_secure(const std::set<Node*>& set) {
+            // If following is true, it is in cache
+            if (const bool* verdict = verified_sets_.find(set); verdict != nullptr) {
+                ++cache_hit_set_;
+                return {true, *verdict};
+            } else if (this->load_set(set)) {
+                ++cache_hit_set_;
+                return {true, *verified_sets_.find(set)};
+            } else if (this->subsume_set(set)) {
+                return {true, *verified_sets_.find(set)};
+            } else {
+                ++cache_miss_set_;
+                return {false, true};
+            }
+        }
+        // Lookup that is not accounted in statistics
+        bool contains_set(const std::set<Node*>& set) {
+            return verified_sets_.find(set) != nullptr or this->load_set(set) or this->subsume_set(set, false);
+        }
+
+        // Same lookups for verdicts that depend on a bound, they are kept in memory only
+        CacheVerdict is_cached_node_secure(Node* node, int bound) {
+            if (const auto& search = bounded_nodes_.find(node); search != bounded_nodes_.end() and search->second.known(bound)) {
+                ++cache_hit_node_;
+                return {true, search->second.is_secure(bound)};
+            }
+            return {false, true};
+        }
+        CacheVerdict is_cached_set_secure(const std::set<Node*>& set, int bound) {
+            if (const auto& search = bounded_sets_.find(fingerprint(set)); search != bounded_sets_.end()
+                and (not exact_sets_ or search->second.first == set) and search->second.second.known(bound)) {
+                ++cache_hit_set_;
+                return {true, search->second.second.is_secure(bound)};
+            }
+            ++cache_miss_set_;
+            return {false, true};
+        }
+
+        void incr_trivial_sets() { ++trivial_sets_skipped_; }
+        void incr_trivial_nodes() { ++trivial_nodes_skipped_; }
+        unsigned int get_trivial_sets() const { return trivial_sets_skipped_; }
+        unsigned int get_hits_sets() const { return cache_hit_set_; }
+        unsigned int get_misses_sets() const { return cache_miss_set_; }
+        unsigned int get_trivial_nodes() const { return trivial_nodes_skipped_; }
+        unsigned int get_hits_nodes() const { return cache_hit_node_; }
+        Counters counters() const {
+            return {cache_hit_node_, cache_hit_set_, cache_miss_set_, trivial_nodes_skipped_, trivial_sets_skipped_};
+        }
+        void add_counters(const Counters& counters) {
+            cache_hit_node_ += counters.hits_nodes_;
+            cache_hit_set_ += counters.hits_sets_;
+            cache_miss_set_ += counters.misses_sets_;
+            trivial_nodes_skipped_ += counters.trivial_nodes_;
+            trivial_sets_skipped_ += counters.trivial_sets_;
+        }
+
+        void add_node_to_cache(Node* node, bool is_secure) {
+            verified_nodes_[node] = is_secure;
+            if (keys_)
+                this->store(keys_->node_key(node), is_secure);
+        }
+        void add_set_to_cache(const std::set<Node*>& set, bool is_secure) {
+            verified_sets_.insert(set, is_secure);
+            if (subsumption_)
+                subsumption_->insert(set, is_secure);
+            if (keys_)
+                this->store(keys_->set_key(set), is_secure);
+        }
+
+        void add_node_to_cache(Node* node, int bound, bool is_secure) {
+            bounded_nodes_[node].record(bound, is_secure);
+        }
+        void add_set_to_cache(const std::set<Node*>& set, int bound, bool is_secure) {
+            auto& [stored, verdict] = bounded_sets_[fingerprint(set)];
+            // A fingerprint collision replaces the stored set
+            if (exact_sets_ and stored != set) {
+                stored = set;
+                verdict = {};
+            }
+            verdict.record(bound, is_secure);
+        }
+
+    private:
+        std::optional<bool> lookup(const Fingerprint& key) {
+            if (persistent_)
+                if (const bool* verdict = persistent_->find(key); verdict != nullptr)
+                    return *verdict;
+            if (shared_)
+                return shared_->find(key);
+            return std::nullopt;
+        }
+        void store(const Fingerprint& key, bool is_secure) {
+            if (persistent_)
+                persistent_->insert(key, is_secure);
+            if (shared_)
+                shared_->insert(key, is_secure);
+        }
+
+        // Copy a verdict from outside of this process in memory, return false if there is none
+        bool load_node(Node* node) {
+            if (not keys_)
+                return false;
+            std::optional<bool> verdict = this->lookup(keys_->node_key(node));
+            if (verdict)
+                verified_nodes_[node] = *verdict;
+            return verdict.has_value();
+        }
+        // Subsumed verdicts are only copied in memory, the index already covers them
+        bool subsume_set(const std::set<Node*>& set, bool counted = true) {
+            if (not subsumption_)
+                return false;
+            std::optional<bool> verdict = subsumption_->find(set, counted);
+            if (verdict)
+                verified_sets_.insert(set, *verdict);
+            return verdict.has_value();
+        }
+        bool load_set(const std::set<Node*>& set) {
+            if (not keys_)
+                return false;
+            std::optional<bool> verdict = this->lookup(keys_->set_key(set));
+            if (verdict) {
+                verified_sets_.insert(set, *verdict);
+                // Loaded verdicts also answer the subsets or supersets of the set
+                if (subsumption_)
+                    subsumption_->insert(set, *verdict);
+            }
+            return verdict.has_value();
+        }
+};
+
+#endif // CACHE_H
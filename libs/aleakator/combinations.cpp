@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <cstdint>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <new>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "combinations.h"
+
+uint64_t combinations::binomial(uint64_t n, uint64_t r) {
+    if (r > n)
+        return 0;
+    r = std::min(r, n - r);
+
+    // Each intermediate result is itself a binomial coefficient. Dividing first by the common factor
+    // keeps the products exact: what remains of k + 1 then divides n - k.
+    uint64_t result = 1;
+    for (uint64_t k = 0; k < r; ++k) {
+        uint64_t common = std::gcd(result, k + 1);
+        uint64_t factor = (n - k) / ((k + 1) / common);
+        result /= common;
+        if (result > std::numeric_limits<uint64_t>::max() / factor)
+            return std::numeric_limits<uint64_t>::max();
+        result *= factor;
+    }
+    return result;
+}
+
+// Chooses elements from the smallest, skipping all the subsets starting with a smaller element
+std::vector<uint32_t> combinations::unrank(uint64_t rank, uint32_t n, uint32_t r) {
+    std::vector<uint32_t> subset;
+    subset.reserve(r);
+    uint32_t element = 0;
+    for (uint32_t i = 0; i < r; ++i) {
+        for (;; ++element) {
+            uint64_t skipped = binomial(n - element - 1, r - i - 1);
+            if (rank < skipped)
+                break;
+            rank -= skipped;
+        }
+        subset.push_back(element++);
+    }
+    return subset;
+}
+
+bool combinations::next(std::vector<uint32_t>& subset, uint32_t n) {
+    uint32_t r = subset.size();
+    // Rightmost element that can still be incremented
+    for (uint32_t i = r; i-- > 0;) {
+        if (subset[i] < n - r + i) {
+            ++subset[i];
+            for (uint32_t j = i + 1; j < r; ++j)
+                subset[j] = subset[j - 1] + 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+SharedFlag::SharedFlag() {
+    void* memory = mmap(nullptr, sizeof(std::atomic<bool>), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+        throw std::runtime_error( "Could not map shared flag." );
+    flag_ = new (memory) std::atomic<bool>(false);
+}
+
+SharedFlag::~SharedFlag() {
+    munmap(flag_, sizeof(std::atomic<bool>));
+}
+
+ChunkCheckpoint::ChunkCheckpoint(const std::filesystem::path& path, uint64_t salt) : path_(path), salt_(salt) {
+    std::ifstream file(path_);
+    Chunk chunk;
+    while (file >> std::get<0>(chunk) >> std::get<1>(chunk) >> std::get<2>(chunk) >> std::get<3>(chunk) >> std::get<4>(chunk)
+        >> std::get<5>(chunk) >> std::get<6>(chunk))
+        done_.insert(chunk);
+}
+
+void ChunkCheckpoint::record(const Chunk& chunk) const {
+    std::string line = std::to_string(std::get<0>(chunk)) + " " + std::to_string(std::get<1>(chunk)) + " "
+        + std::to_string(std::get<2>(chunk)) + " " + std::to_string(std::get<3>(chunk)) + " "
+        + std::to_string(std::get<4>(chunk)) + " " + std::to_string(std::get<5>(chunk)) + " "
+        + std::to_string(std::get<6>(chunk)) + "\n";
+
+    int fd = open(path_.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0 or write(fd, line.data(), line.size()) != static_cast<ssize_t>(line.size()))
+        std::cerr << "Could not record checkpoint to " << path_ << std::endl;
+    if (fd >= 0)
+        close(fd);
+}
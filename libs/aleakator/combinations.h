@@ -0,0 +1,64 @@
+#ifndef COMBINATIONS_H
+#define COMBINATIONS_H
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <set>
+#include <tuple>
+#include <vector>
+
+// Enumeration of the r-subsets of [0, n) in lexicographic order. Any subset can be obtained from its
+// rank (combinadic unranking), so that the enumeration can be split in chunks of consecutive ranks
+// verified independently, then walked with next().
+namespace combinations {
+    // Saturates at UINT64_MAX
+    uint64_t binomial(uint64_t n, uint64_t r);
+    // Subset of the given rank, rank must be lower than binomial(n, r)
+    std::vector<uint32_t> unrank(uint64_t rank, uint32_t n, uint32_t r);
+    // Advances to the following subset, returns false after the last one
+    bool next(std::vector<uint32_t>& subset, uint32_t n);
+}
+
+// Flag visible to the process that creates it and to all the processes it forks afterwards, used to
+// stop workers once one of them found a leak.
+class SharedFlag {
+    private:
+        std::atomic<bool>* flag_;
+
+    public:
+        SharedFlag();
+        ~SharedFlag();
+        SharedFlag(const SharedFlag&) = delete;
+        SharedFlag& operator=(const SharedFlag&) = delete;
+
+        void set() const { flag_->store(true, std::memory_order_relaxed); }
+        bool is_set() const { return flag_->load(std::memory_order_relaxed); }
+};
+
+// Chunks of enumerations already proven secure, kept in a file so that an interrupted run can resume
+// where it stopped. A chunk is identified by a salt for the verification settings, a key of the
+// expressions enumerated, the cycle, the size of the enumeration, the size of the chunks and its
+// index: a file left by another version of the circuit or program matches no chunk. Each process
+// appends the chunks it completes, with a single write per chunk.
+class ChunkCheckpoint {
+    public:
+        using Chunk = std::tuple<uint64_t, uint64_t, uint64_t, uint64_t, uint64_t, uint64_t, uint64_t>;
+
+    private:
+        const std::filesystem::path path_;
+        const uint64_t salt_;
+        std::set<Chunk> done_{};
+
+    public:
+        ChunkCheckpoint(const std::filesystem::path& path, uint64_t salt);
+
+        Chunk chunk(uint64_t content, uint64_t cycle, uint64_t n, uint64_t r, uint64_t chunk_size, uint64_t index) const {
+            return {salt_, content, cycle, n, r, chunk_size, index};
+        }
+        bool is_done(const Chunk& chunk) const { return done_.contains(chunk); }
+        void record(const Chunk& chunk) const;
+        size_t size() const { return done_.size(); }
+};
+
+#endif // COMBINATIONS_H
@@ -25,10 +25,24 @@ Configuration::Configuration(int argc, char *argv[], CircuitType circuit_type, c
         ("detailed", po::value<bool>()->default_value(this->DETAIL_LEAKS_INFORMATION_)->implicit_value(true), "Give full information about position in circuit about identified leaks")
         ("show-expr", po::value<bool>()->default_value(this->DETAIL_SHOW_EXPRESSION_)->implicit_value(true), "Display the expressions (be carefull, they may be too big to print) for identified leaks")
         ("track", po::value<bool>()->default_value(this->TRACK_LEAKS_)->implicit_value(true), "Tracks leakage up to the root of the leakage")
+        ("exact-set-cache", po::value<bool>()->default_value(this->CACHE_EXACT_SETS_)->implicit_value(true), "Store verified sets in cache to confirm fingerprint hits")
+        ("persistent-cache", po::value<bool>()->default_value(this->PERSISTENT_CACHE_)->implicit_value(true), "Reuse and save verification verdicts in a file shared by the runs of the same program")
+        ("set-subsumption", po::value<bool>()->default_value(this->SET_SUBSUMPTION_)->implicit_value(true), "Reuse verdicts of glitch sets that contain (secure) or are contained in (leaking) the verified set")
+        ("secret-support-filter", po::value<bool>()->default_value(this->SECRET_SUPPORT_FILTER_)->implicit_value(true), "Skip the proofs of expressions that do not depend on any secret")
+        ("shared-cache", po::value<std::string>()->default_value(this->SHARED_CACHE_), "Memory mapped file of verification verdicts shared by the processes running on the host")
+        ("shared-cache-slots", po::value<size_t>()->default_value(this->SHARED_CACHE_SLOTS_), "Number of verdicts held by the shared cache when it is created, older verdicts are evicted")
         ("ho-spatial", po::value<bool>()->default_value(false)->implicit_value(true), "Higher order means spatial for you. This is the default.")
         ("ho-temporal", po::value<bool>()->default_value(false)->implicit_value(true), "Higher order means temporal for you")
         ("order", po::value<size_t>()->default_value(this->ORDER_VERIF_), "Order of verification to perform.")
+        ("order-sweep", po::value<bool>()->default_value(this->ORDER_SWEEP_)->implicit_value(true), "Verify all orders from 1 up to the given order, leaks of lower orders are propagated (spatial only)")
         ("property", po::value<std::string>()->default_value("TPS"), "Security property to verify.")
+        ("jobs", po::value<size_t>()->default_value(this->JOBS_), "Number of worker processes used to prove the obligations of a cycle.")
+        ("pipeline-depth", po::value<size_t>()->default_value(this->PIPELINE_DEPTH_), "Number of cycles that may be verified in background while the following ones are simulated, 0 disables pipelining.")
+        ("ho-chunk-size", po::value<size_t>()->default_value(this->HO_CHUNK_SIZE_), "Number of tuples per chunk of higher order spatial verification, chunks are spread over the jobs.")
+        ("ho-checkpoint", po::value<bool>()->default_value(this->HO_CHECKPOINT_)->implicit_value(true), "Record verified higher order spatial chunks and skip those recorded by previous runs")
+        ("ho-window", po::value<size_t>()->default_value(this->HO_WINDOW_), "Number of past cycles combined with the current one in higher order temporal verification, 0 for all of them")
+        ("lazy-leaksets", po::value<bool>()->default_value(this->LAZY_LEAKSETS_)->implicit_value(true), "Record how leaksets are computed and only compute those that are verified or printed")
+        ("op-memo", po::value<size_t>()->default_value(this->OP_MEMO_), "Number of results of symbolic operations memoized across cycles, 0 disables the memoization")
     ;
 
     // Only for CPUs, take a subprogram as option. It is positional
@@ -64,7 +78,21 @@ Configuration::Configuration(int argc, char *argv[], CircuitType circuit_type, c
     this->DETAIL_LEAKS_INFORMATION_ = vm["detailed"].as<bool>();
     this->DETAIL_SHOW_EXPRESSION_ = vm["show-expr"].as<bool>();
     this->TRACK_LEAKS_ = vm["track"].as<bool>();
+    this->CACHE_EXACT_SETS_ = vm["exact-set-cache"].as<bool>();
+    this->PERSISTENT_CACHE_ = vm["persistent-cache"].as<bool>();
+    this->SET_SUBSUMPTION_ = vm["set-subsumption"].as<bool>();
+    this->SECRET_SUPPORT_FILTER_ = vm["secret-support-filter"].as<bool>();
+    this->SHARED_CACHE_ = vm["shared-cache"].as<std::string>();
+    this->SHARED_CACHE_SLOTS_ = vm["shared-cache-slots"].as<size_t>();
     this->ORDER_VERIF_ = vm["order"].as<size_t>();
+    this->ORDER_SWEEP_ = vm["order-sweep"].as<bool>();
+    this->JOBS_ = vm["jobs"].as<size_t>();
+    this->PIPELINE_DEPTH_ = vm["pipeline-depth"].as<size_t>();
+    this->HO_CHUNK_SIZE_ = vm["ho-chunk-size"].as<size_t>();
+    this->HO_CHECKPOINT_ = vm["ho-checkpoint"].as<bool>();
+    this->HO_WINDOW_ = vm["ho-window"].as<size_t>();
+    this->LAZY_LEAKSETS_ = vm["lazy-leaksets"].as<bool>();
+    this->OP_MEMO_ = vm["op-memo"].as<size_t>();
 
     if (vm["ho-spatial"].as<bool>() and vm["ho-temporal"].as<bool>())
         throw std::invalid_argument( "ho-spatial and ho-temporal are mutually exclusive." );
@@ -96,11 +124,25 @@ Configuration::Configuration(int argc, char *argv[], CircuitType circuit_type, c
     if (this->SECURITY_PROPERTY_ == leaks::SNI and (this->VERIF_TRANSITION_W_GLITCHES_ or this->VERIF_TRANSITION_WO_GLITCHES_ or (this->ORDER_VERIF_ > 1 and HIGHER_ORDER_TYPE_ == TEMPORAL)))
         throw std::invalid_argument( "Transitions are not defined for SNI verification." );
 
+    if (this->PIPELINE_DEPTH_ > 0 and this->ORDER_VERIF_ > 1)
+        throw std::invalid_argument( "Pipelining is only supported for first order verification." );
+
+    if (this->PIPELINE_DEPTH_ > 0 and this->DETAIL_LEAKS_INFORMATION_)
+        throw std::invalid_argument( "Detailed leaks show live wire values, they cannot be pipelined." );
+
+    if (this->ORDER_SWEEP_ and (this->ORDER_VERIF_ <= 1 or this->HIGHER_ORDER_TYPE_ != SPATIAL))
+        throw std::invalid_argument( "Order sweep is only supported for higher order spatial verification." );
+
+    if (this->HO_CHUNK_SIZE_ < 1)
+        throw std::invalid_argument( "Higher order chunks must contain at least one tuple." );
+
     this->init_working_path(argv[0]);
 
     // Check that config is coherent
     assert((this->ORDER_VERIF_ >= 1) && "Verification order should be superior or equal to one");
     assert((this->SKIP_VERIF_CYCLES_ >= 0) && "Skip verif cycle should be superior or equal to zero");
+    assert((this->JOBS_ >= 1) && "At least one job is needed to verify");
+    assert((this->SHARED_CACHE_SLOTS_ >= 1) && "The shared cache needs at least one slot");
     assert((not this->EXIT_AT_FIRST_LEAK_ or this->EXIT_AT_FIRST_LEAKING_CYCLE_) && "If exit at first leak is set, exit at first leaking cycle should be set");
 }
 
@@ -160,6 +202,12 @@ std::ostream& operator<<(std::ostream& os, Configuration const& m) {
     os << "DETAIL_LEAKS_INFORMATION:" << m.DETAIL_LEAKS_INFORMATION_ << std::endl;
     os << "DETAIL_SHOW_EXPRESSION:" << m.DETAIL_SHOW_EXPRESSION_ << std::endl;
     os << "TRACK_LEAKS_:" << m.TRACK_LEAKS_ << std::endl;
+    os << "CACHE_EXACT_SETS:" << m.CACHE_EXACT_SETS_ << std::endl;
+    os << "PERSISTENT_CACHE:" << m.PERSISTENT_CACHE_ << std::endl;
+    os << "SET_SUBSUMPTION:" << m.SET_SUBSUMPTION_ << std::endl;
+    os << "SECRET_SUPPORT_FILTER:" << m.SECRET_SUPPORT_FILTER_ << std::endl;
+    os << "SHARED_CACHE:" << m.SHARED_CACHE_ << std::endl;
+    os << "SHARED_CACHE_SLOTS:" << m.SHARED_CACHE_SLOTS_ << std::endl;
     os << std::noboolalpha;
 
     os << "SECURITY_PROPERTY:" << m.SECURITY_PROPERTY_ << std::endl;
@@ -167,6 +215,14 @@ std::ostream& operator<<(std::ostream& os, Configuration const& m) {
     os << "HIGHER_ORDER_TYPE:" << (m.HIGHER_ORDER_TYPE_ == Configuration::TEMPORAL ? "TEMPORAL" : "SPATIAL") << std::endl;
     os << "SKIP_VERIF_CYCLES:" << m.SKIP_VERIF_CYCLES_ << std::endl;
     os << "CYCLES_TO_VERIFY:" << m.CYCLES_TO_VERIFY_ << std::endl;
+    os << "JOBS:" << m.JOBS_ << std::endl;
+    os << "PIPELINE_DEPTH:" << m.PIPELINE_DEPTH_ << std::endl;
+    os << "ORDER_SWEEP:" << m.ORDER_SWEEP_ << std::endl;
+    os << "HO_CHUNK_SIZE:" << m.HO_CHUNK_SIZE_ << std::endl;
+    os << "HO_CHECKPOINT:" << m.HO_CHECKPOINT_ << std::endl;
+    os << "HO_WINDOW:" << m.HO_WINDOW_ << std::endl;
+    os << "LAZY_LEAKSETS:" << m.LAZY_LEAKSETS_ << std::endl;
+    os << "OP_MEMO:" << m.OP_MEMO_ << std::endl;
     if (not m.EXCEPTIONS_WORD_VERIF_.empty()) {
         os << "EXCEPTIONS_WORD_VERIF:" << std::endl;
         for (const auto &[wire, width] : m.EXCEPTIONS_WORD_VERIF_) {
@@ -34,15 +34,43 @@ class Configuration {
         bool DETAIL_LEAKS_INFORMATION_ = false;
         bool DETAIL_SHOW_EXPRESSION_ = false;
         bool TRACK_LEAKS_ = false;
+        // Confirm set cache hits by comparing the sets, not only their fingerprints
+        bool CACHE_EXACT_SETS_ = false;
+        // Keep verdicts in a file next to leak_data to warm start the next runs
+        bool PERSISTENT_CACHE_ = false;
+        // Answer glitch sets from known supersets (secure) and subsets (leaking), not for SNI
+        bool SET_SUBSUMPTION_ = true;
+        // Consider expressions without any secret symbol as secure without proving them, not for SNI
+        bool SECRET_SUPPORT_FILTER_ = true;
+        // File of the verdict table shared by the processes of the host, empty to not share
+        std::string SHARED_CACHE_{};
+        // Number of verdicts the shared table holds when it is created
+        size_t SHARED_CACHE_SLOTS_ = 1 << 20;
 
         std::map<std::string, int> EXCEPTIONS_WORD_VERIF_;
 
         leaks::Properties SECURITY_PROPERTY_ = leaks::Properties::TPS;
         size_t ORDER_VERIF_ = 1;
         HigherOrderType HIGHER_ORDER_TYPE_ = HigherOrderType::SPATIAL;
+        // Verify every order from 1 up to ORDER_VERIF_ at each cycle, spatial only
+        bool ORDER_SWEEP_ = false;
         size_t SKIP_VERIF_CYCLES_ = 0;
         // For now this does include the reset cycles
         int64_t CYCLES_TO_VERIFY_ = std::numeric_limits<int64_t>::max();
+        // Number of worker processes proving the obligations of a cycle
+        size_t JOBS_ = 1;
+        // Number of cycles whose proofs may still run while the following cycles are simulated
+        size_t PIPELINE_DEPTH_ = 0;
+        // Number of tuples per chunk of the higher order spatial enumeration
+        size_t HO_CHUNK_SIZE_ = 1 << 20;
+        // Record completed chunks next to leak_data so that an interrupted run can resume
+        bool HO_CHECKPOINT_ = false;
+        // Number of past cycles combined with the current one in higher order temporal verification, 0 keeps them all
+        size_t HO_WINDOW_ = 0;
+        // Compute leaksets bits only when they are verified or printed
+        bool LAZY_LEAKSETS_ = false;
+        // Maximum number of memoized results of symbolic operations, 0 disables the memoization
+        size_t OP_MEMO_ = 0;
 
 
     public:
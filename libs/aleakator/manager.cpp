@@ -2,11 +2,16 @@
 #include "cxxrtl/capi/cxxrtl_capi.h"
 #include "cxxrtl/cxxrtl.h"
 #include "lss.h"
+#include <algorithm>
+#include <array>
 #include <cstdint>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <numeric>
 #include <ranges>
 #include <regex>
+#include <unistd.h>
 namespace fs = std::filesystem;
 
 #include "verif_msi_pp.hpp"
@@ -37,7 +42,8 @@ int current_ram() {
     return result/1000;
 }
 
-Manager::Manager (cxxrtl::module& top, Configuration config) : config_(config) {
+Manager::Manager (cxxrtl::module& top, Configuration config) : config_(config), history_ho_((config_.HO_WINDOW_ > 0) ? config_.HO_WINDOW_ + 1 : 0),
+    cache_(config_.CACHE_EXACT_SETS_), prover_pool_(config_.JOBS_), order_(config_.ORDER_VERIF_) {
     top.debug_info(&this->dbg_items_, nullptr, "");
     config_.dump();
 
@@ -51,6 +57,41 @@ Manager::Manager (cxxrtl::module& top, Configuration config) : config_(config) {
     simulation_logger = std::ofstream{config_.working_path_/"simulation.txt"};
     leakage_file_ = std::ofstream{config_.working_path_/"leaks.txt"};
 
+    leaks::set_lazy(config_.LAZY_LEAKSETS_);
+    cxxrtl::op_memo::enable(config_.OP_MEMO_);
+
+    // SNI verdicts are cached by bound, the subsumption index only holds the others
+    if (config_.SET_SUBSUMPTION_ and config_.SECURITY_PROPERTY_ != leaks::Properties::SNI)
+        cache_.use_subsumption();
+    // Expressions without secret are only known to be secure for TPS and NI
+    if (config_.SECRET_SUPPORT_FILTER_ and config_.SECURITY_PROPERTY_ != leaks::Properties::SNI)
+        cache_.use_secret_support();
+
+    // Verdicts depend on the verification settings, they are part of every key
+    if (config_.PERSISTENT_CACHE_ or not config_.SHARED_CACHE_.empty())
+        cache_.use_structural_keys(fingerprint(std::vector<uint64_t>{static_cast<uint64_t>(config_.SECURITY_PROPERTY_),
+            config_.ORDER_VERIF_, config_.REMOVE_FALSE_NEGATIVE_, config_.BIT_VERIF_}).high_);
+    if (config_.PERSISTENT_CACHE_) {
+        fs::path path = config_.working_path_.parent_path()/(config_.program_ + "_" + config_.subprogram_ + ".verdicts");
+        cache_.persist_to(path);
+        std::cout << "Loaded " << cache_.persistent()->get_loaded() << " verdicts from " << path << std::endl;
+    }
+    if (not config_.SHARED_CACHE_.empty()) {
+        cache_.share_through(config_.SHARED_CACHE_, config_.SHARED_CACHE_SLOTS_);
+        std::cout << "Attached to shared cache " << config_.SHARED_CACHE_ << " of " << cache_.shared()->capacity() << " verdicts" << std::endl;
+    }
+
+    // Chunks depend on the verification settings, which are part of their identifier, including
+    // the support filter that reorders the tuples
+    if (config_.HO_CHECKPOINT_ and config_.ORDER_VERIF_ > 1 and config_.HIGHER_ORDER_TYPE_ == Configuration::SPATIAL) {
+        fs::path path = config_.working_path_.parent_path()/(config_.program_ + "_" + config_.subprogram_ + ".checkpoint");
+        checkpoint_ = std::make_unique<ChunkCheckpoint>(path, fingerprint(std::vector<uint64_t>{static_cast<uint64_t>(config_.SECURITY_PROPERTY_),
+            config_.ORDER_VERIF_, config_.REMOVE_FALSE_NEGATIVE_, config_.BIT_VERIF_, config_.VERIF_VALUE_WO_GLITCHES_, config_.VERIF_VALUE_W_GLITCHES_, config_.SECRET_SUPPORT_FILTER_}).high_);
+        checkpoint_keys_ = std::make_unique<StructuralKeys>(0);
+        if (checkpoint_->size() > 0)
+            std::cout << "Resuming from " << checkpoint_->size() << " verified chunks in " << path << std::endl;
+    }
+
     // Parse circuit and fil internal maps
     std::ofstream parse_log_file(config_.working_path_/"parsed_dependencies.txt");
     this->parse_circuit(parse_log_file);
@@ -77,6 +118,7 @@ Manager::Manager (cxxrtl::module& top, Configuration config) : config_(config) {
 }
 
 Manager::~Manager() {
+    this->cancel_verifications();
     simulation_logger.close();
     leakage_file_.close();
 }
@@ -90,7 +132,12 @@ bool Manager::step(cxxrtl::module& top) {
     std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
     bool converged = top.eval();
     std::cout << "Evaluating cycle took " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin).count() << "ms." << std::endl;
-    if (is_measuring()) {
+    if (is_measuring() and config_.PIPELINE_DEPTH_ > 0 and config_.SKIP_VERIF_CYCLES_ <= steps_) {
+        // Proofs of this cycle run while the next ones are evaluated, only the oldest are concluded
+        this->schedule_verify();
+        if (not this->retire_verifications(config_.PIPELINE_DEPTH_))
+            return false;
+    } else if (is_measuring()) {
         if ((config_.ORDER_VERIF_ == 1 and not this->verify()) or
             (config_.ORDER_VERIF_ > 1 and not this->verify_higher_order())) {
             std::cout << "Leaks found in simulation step " << steps_ << std::endl;
@@ -100,8 +147,12 @@ bool Manager::step(cxxrtl::module& top) {
         }
     }
 
+    // Save the verdicts of the cycle for the next runs
+    cache_.flush();
+
     if (top.commit() && !converged) {
         std::cout << "Evaluating further would mean delta-cycle execution, bailing out." << std::endl;
+        this->retire_verifications(0);
         return false;
     }
 
@@ -114,6 +165,7 @@ bool Manager::step(cxxrtl::module& top) {
 
     if (steps_ >= config_.CYCLES_TO_VERIFY_) {
         std::cout << "Reached the end of cycles to verify, stopping gracefully." << config_.CYCLES_TO_VERIFY_ << " - " << steps_ << std::endl;
+        this->retire_verifications(0);
         return false;
     }
 
@@ -123,35 +175,54 @@ bool Manager::step(cxxrtl::module& top) {
 
 void Manager::clean(cxxrtl::module& top) {
     std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    // Only the leaksets of the elected wires are ever computed, the others are kept lazily
     for (auto& cycle : database_) {
-        for (const auto& [wire, entry] : cycle) {
-            leaks::keep(entry.leakset_);
+        for (const auto& entry : cycle) {
+            leaks::keep_lazy(entry.leakset_);
         }
     }
-    if (config_.ORDER_VERIF_ > 1) {
-        for (auto& cycle : database_ho_) {
-            for (const auto& [wire, entry] : cycle) {
+    for (size_t i = 0; i < history_ho_.size(); ++i)
+        for (leaks::LeakSet* leakset : history_ho_[i].words_.leaksets_)
+            leaks::keep(leakset);
+    // Cycles still being verified in background need their leaksets until they are concluded
+    for (const auto& pending : pending_cycles_) {
+        for (const auto& cycle : pending.database_)
+            for (const auto& entry : cycle)
+                leaks::keep(entry.leakset_);
+        for (const auto& cycle : pending.database_memory_)
+            for (const auto& [wire, entry] : cycle)
                 leaks::keep(entry.leakset_);
-            }
-        }
     }
     std::cout << "Keeping database and memories leaksets took " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin).count() << "ms." << std::endl;
 
     // Also keep needed state elements
     top.symb_keep();
+    // Memoized results refer to leaksets of previous cycles
+    if (cxxrtl::op_memo::enabled())
+        cxxrtl::op_memo::keep();
     leaks::clear();
+    const leaks::ArenaStats& arena = leaks::arena_stats();
+    std::cout << "Leaksets allocated: " << arena.allocated_ << " (" << arena.allocated_bytes_ / 1024 << "kB), retained: "
+        << arena.retained_ << " (" << arena.retained_bytes_ / 1024 << "kB), distinct bit sets: " << leaks::BitLeaks::interned() << ", sliced nodes: " << leaks::bit_slices() << "." << std::endl;
+    if (config_.LAZY_LEAKSETS_)
+        std::cout << "Leaksets never computed: " << arena.deferred_ << "." << std::endl;
+    std::cout << "Register commit leaksets freed: " << arena.commits_ << ", never read: " << arena.unread_commits_ << "." << std::endl;
+    if (cxxrtl::op_memo::enabled()) {
+        const cxxrtl::op_memo::stats& memo = cxxrtl::op_memo::statistics();
+        std::cout << "Memoized operations: " << cxxrtl::op_memo::size() << ", hits: " << memo.hits_ << ", misses: " << memo.misses_
+            << ", dropped: " << memo.dropped_ << ", evicted: " << memo.evicted_ << "." << std::endl;
+    }
     // We do not clear ir anymore because, the value from the previous cycle is used in buildDatabase
     //wires_requiring_verification.clear();
     std::cout << "Keeping database + state leaksets took " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin).count() << "ms." << std::endl;
 }
 
-// Iterate over the structure once and create the internal structure of the maps inside database
+// Iterate over the structure once and create the internal structure of the database
 // Also, populate a set containing all the registers and outputs wires
 void Manager::init_database() {
-    // Clear just in case
-    database_[0].clear();
-
-    registers_and_outputs_.clear();
+    // The skeleton is built by name, wires are then given identifiers in name order
+    std::map<std::string, Entry> skeleton;
+    std::set<std::string> registers_and_outputs;
 
     // Iterate over the debug structure
     for(const auto& [name, element] : dbg_items_.table) {
@@ -180,11 +251,11 @@ void Manager::init_database() {
 
             // Always add registers and outputs to glitch verification
             if (contains_wire || contains_output)
-                registers_and_outputs_.insert(filtered_name);
+                registers_and_outputs.insert(filtered_name);
 
             Entry entry{(contains_wire ? Entry::WIRE : Entry::VALUE), total_size, contains_output,
                 nullptr, nullptr};
-            database_[0][filtered_name] = entry;
+            skeleton[filtered_name] = entry;
         } else {
             const auto& part = *(element.begin());
 
@@ -194,39 +265,122 @@ void Manager::init_database() {
 
             // Always add registers and outputs to glitch verification
             if (part.type == CXXRTL_WIRE || (part.flags & CXXRTL_OUTPUT))
-                registers_and_outputs_.insert(filtered_name);
+                registers_and_outputs.insert(filtered_name);
 
             Entry entry{(part.type == CXXRTL_WIRE ? Entry::WIRE : Entry::VALUE),
                 static_cast<uint16_t>(part.width), static_cast<bool>(part.flags & CXXRTL_OUTPUT), nullptr, nullptr};
-            database_[0][filtered_name] = entry;
+            skeleton[filtered_name] = entry;
         }
     }
 
     // Retrospectively split exception signals, only valid for word verif
     if (not config_.BIT_VERIF_) {
         for (const auto& [signal, width] : config_.EXCEPTIONS_WORD_VERIF_) {
-            assert(database_[0].contains(signal)); // Before they were ignored but just in case
-            bool is_reg_or_out = registers_and_outputs_.contains(signal);
+            assert(skeleton.contains(signal)); // Before they were ignored but just in case
+            bool is_reg_or_out = registers_and_outputs.contains(signal);
 
-            for (int i = 0; i < database_[0][signal].width_ / width; i++) {
-                uint16_t part_width = ((i+1)*width < database_[0][signal].width_) ? width : (database_[0][signal].width_ - (i*width));
+            for (int i = 0; i < skeleton[signal].width_ / width; i++) {
+                uint16_t part_width = ((i+1)*width < skeleton[signal].width_) ? width : (skeleton[signal].width_ - (i*width));
 
-                Entry entry{database_[0][signal].type_, part_width, database_[0][signal].is_output_, nullptr, nullptr};
-                database_[0][std::string("split_exception_") + signal + std::string("_") + std::to_string(i)] = entry;
+                Entry entry{skeleton[signal].type_, part_width, skeleton[signal].is_output_, nullptr, nullptr};
+                skeleton[std::string("split_exception_") + signal + std::string("_") + std::to_string(i)] = entry;
 
                 // If we were supposed to check the original signal, add the sub one to the list
                 if (is_reg_or_out)
-                    registers_and_outputs_.insert(std::string("split_exception_") + signal + std::string("_") + std::to_string(i));
+                    registers_and_outputs.insert(std::string("split_exception_") + signal + std::string("_") + std::to_string(i));
             }
-            database_[0].erase(signal);
+            skeleton.erase(signal);
 
             // All sub signals have been added, so remove the original signal from the list
-            registers_and_outputs_.erase(signal);
+            registers_and_outputs.erase(signal);
         }
     }
 
+    database_[0].clear();
+    for (const auto& [name, entry] : skeleton) {
+        wires_.intern(name);
+        database_[0].push_back(entry);
+    }
+
+    registers_and_outputs_.clear();
+    for (const auto& name : registers_and_outputs)
+        registers_and_outputs_.insert(wires_.id(name));
+
     // Duplicate skeleton
     database_[1] = database_[0];
+
+    this->index_circuit();
+}
+
+// Resolve once all the names that build_database would otherwise look up at each cycle
+void Manager::index_circuit() {
+    const size_t database_size = database_[0].size();
+
+    for(const auto& [name, element] : dbg_items_.table) {
+        std::string filtered_name = name;
+        std::replace(filtered_name.begin(), filtered_name.end(), '.', ' ');
+        // Exceptionally split wires are handled after
+        if (not config_.BIT_VERIF_ and config_.EXCEPTIONS_WORD_VERIF_.contains(filtered_name)) continue;
+
+        if (element.size() == 1) {
+            const auto& part = *(element.begin());
+            if (part.leakref == nullptr || part.type == CXXRTL_ALIAS) continue;
+            // Memories are not in the database, their cells are named from the memory name
+            if (part.type == CXXRTL_MEMORY) {
+                debug_wires_.push_back({wires_.intern(filtered_name), &element});
+                continue;
+            }
+        }
+        debug_wires_.push_back({wires_.id(filtered_name), &element});
+    }
+
+    if (not config_.BIT_VERIF_) {
+        for (const auto& [signal, width] : config_.EXCEPTIONS_WORD_VERIF_) {
+            std::string filtered_name = signal;
+            std::replace(filtered_name.begin(), filtered_name.end(), '.', ' ');
+
+            SplitException split{wires_.intern(filtered_name), width, &*dbg_items_.table.at(filtered_name).begin(), {}};
+            for (int i = 0; wires_.contains(std::string("split_exception_") + signal + std::string("_") + std::to_string(i)); i++)
+                split.parts_.push_back(wires_.id(std::string("split_exception_") + signal + std::string("_") + std::to_string(i)));
+            split_exceptions_.push_back(split);
+        }
+    }
+
+    // Inputs of wires that are not in the database cannot be elected, they are not needed
+    gate_inputs_.assign(database_size, {});
+    for (const auto& [wire, iwires] : topology_) {
+        if (not wires_.contains(wire) or wires_.id(wire) >= database_size)
+            continue;
+        for (const auto& iwire : iwires)
+            gate_inputs_[wires_.id(wire)].push_back(wires_.intern(iwire));
+    }
+
+    for (const auto& [selector, pair] : mux_structures_) {
+        auto& [a, b] = mux_inputs_[wires_.intern(selector)];
+        for (const auto& iwire : pair.first)
+            a.push_back(wires_.intern(iwire));
+        for (const auto& iwire : pair.second)
+            b.push_back(wires_.intern(iwire));
+    }
+
+    std::set<WireId> split_wires;
+    for (const auto& wire : split_wires_)
+        split_wires.insert(wires_.intern(wire));
+
+    // All names are interned by now, memory cells excepted, they are never elected
+    inputs_of_stabilized_gate_ = WireSet(wires_.size());
+    always_elected_ = WireSet(wires_.size());
+
+    // When force verif all is set
+    if (config_.FORCE_VERIFY_ALL_)
+        always_elected_.insert_below(database_size);
+
+    // Add splitted wires for word verif
+    if (not config_.BIT_VERIF_)
+        always_elected_.insert(split_wires.cbegin(), split_wires.cend());
+
+    // Add registers and primary outputs
+    always_elected_.insert(registers_and_outputs_.cbegin(), registers_and_outputs_.cend());
 }
 
 void Manager::build_database() {
@@ -236,27 +390,24 @@ void Manager::build_database() {
     inputs_of_stabilized_gate_.clear();
 
     // Advance databases cycles
-    // Note that the structure of database is fixed, the memory one is the only one cleared
-    database_[1] = database_[0];
+    // Note that the structure of database is fixed and every entry is rewritten below, so the two
+    // cycles can be swapped. The memory one is the only one cleared
+    std::swap(database_[0], database_[1]);
     // TODO: Check if we are correct here
     database_memory_[0].clear();
     database_memory_[1].clear();
 
-    for(const auto& [name, element] : dbg_items_.table) {
-        std::string filtered_name = name;
-        std::replace(filtered_name.begin(), filtered_name.end(), '.', ' ');
-        // Exceptionally split wires are handled after
-        if (not config_.BIT_VERIF_ and config_.EXCEPTIONS_WORD_VERIF_.contains(filtered_name)) continue;
+    std::vector<std::tuple<WireId, Entry, Entry>> memory_cells;
 
-        if (element.size() > 1) {
+    for (const auto& [wire, element] : debug_wires_) {
+        if (element->size() > 1) {
             std::vector<Node*> nodes_to_merge;
-            std::vector<std::set<Node*>> lss_to_merge(database_[0][filtered_name].width_);
+            std::vector<std::pair<leaks::LeakSet*, size_t>> lss_to_merge;
             bool applied_stability = false;
-            bool is_leakset_empty = true;
             unsigned int current_position = 0;
 
             // The parts are in the order of the lsb_at collumn
-            for(const auto& part : element) {
+            for(const auto& part : *element) {
                 if (part.leakref == nullptr || part.type == CXXRTL_ALIAS) continue;
 
                 // Detect if there is at least one bit of stability set
@@ -270,36 +421,35 @@ void Manager::build_database() {
                 // We asserted at construction that it was not a memory so it is valid
                 auto [node, ls] = part.leakref->leak_single();
                 nodes_to_merge.push_back(node);
-                if (ls != nullptr) {
-                    is_leakset_empty = false;
-                    std::ranges::copy_n(ls->leaks.cbegin(), part.width, lss_to_merge.begin() + current_position);
-                }
+                lss_to_merge.emplace_back(ls, part.width);
 
                 current_position += part.width;
             }
+            // Bits not covered by parts have no leakage
+            if (current_position < database_[0][wire].width_)
+                lss_to_merge.emplace_back(nullptr, database_[0][wire].width_ - current_position);
 
             Node* merged_nodes = &simplify(Concat(nodes_to_merge));
             //assert(merged_nodes->width == current_position);
-            leaks::LeakSet* merged_ls = (is_leakset_empty) ? nullptr : new leaks::LeakSet(lss_to_merge);
+            leaks::LeakSet* merged_ls = leaks::concat(lss_to_merge);
 
             // Add inputs of a gate to verif if the gate applied stabilty
             if (applied_stability and config_.USE_STABILITY_) {
-                inputs_of_stabilized_gate_.insert(topology_[filtered_name].cbegin(), topology_[filtered_name].cend());
+                inputs_of_stabilized_gate_.insert(gate_inputs_[wire].cbegin(), gate_inputs_[wire].cend());
             }
 
-            database_[0][filtered_name].expr_ = merged_nodes;
-            database_[0][filtered_name].leakset_ = merged_ls;
+            database_[0][wire].expr_ = merged_nodes;
+            database_[0][wire].leakset_ = merged_ls;
         } else {
-            const auto& part = *(element.begin());
+            const auto& part = *(element->begin());
             bool applied_stability = false;
-            if (part.leakref == nullptr || part.type == CXXRTL_ALIAS) continue;
 
-            // Memory are handled in a separate map
+            // Memory are handled in a separate database
             if (part.type == CXXRTL_MEMORY) {
                 for (const auto& [index, prev, curr] : part.leakref->leak_mem()) {
-                    std::string cell_name = std::string("mem_") + filtered_name + std::string("_") + std::to_string(index);
-                    database_memory_[0][cell_name] = Entry{Entry::WIRE, 32, false, curr.first, curr.second};
-                    database_memory_[1][cell_name] = Entry{Entry::WIRE, 32, false, prev.first, prev.second};
+                    memory_cells.push_back({this->memory_cell(wire, index),
+                        Entry{Entry::WIRE, 32, false, curr.first, curr.second},
+                        Entry{Entry::WIRE, 32, false, prev.first, prev.second}});
                 }
                 continue;
             }
@@ -313,65 +463,116 @@ void Manager::build_database() {
 
             // Add inputs of a gate to verif if the gate applied stabilty
             if (applied_stability and config_.USE_STABILITY_) {
-                inputs_of_stabilized_gate_.insert(topology_[filtered_name].cbegin(), topology_[filtered_name].cend());
+                inputs_of_stabilized_gate_.insert(gate_inputs_[wire].cbegin(), gate_inputs_[wire].cend());
             }
 
             // Special case for multiplexors, as dead branch must be verified if the selector applied stability (even if the selected entry is fully unstable)
             // If is sufficent to not check for this case in the splitwires part as selectors can only be one bit wide
-            if (config_.USE_STABILITY_ and applied_stability and mux_structures_.contains(filtered_name)) {
-                if (part.curr[0] == 0x0u) {
-                    // Dead branch is the S=1 so port B
-                    inputs_of_stabilized_gate_.insert(mux_structures_[filtered_name].second.cbegin(), mux_structures_[filtered_name].second.cend());
-                } else {
-                    // Dead branch is the S=0 so port A
-                    inputs_of_stabilized_gate_.insert(mux_structures_[filtered_name].first.cbegin(), mux_structures_[filtered_name].first.cend());
+            if (config_.USE_STABILITY_ and applied_stability) {
+                if (const auto& mux = mux_inputs_.find(wire); mux != mux_inputs_.end()) {
+                    if (part.curr[0] == 0x0u) {
+                        // Dead branch is the S=1 so port B
+                        inputs_of_stabilized_gate_.insert(mux->second.second.cbegin(), mux->second.second.cend());
+                    } else {
+                        // Dead branch is the S=0 so port A
+                        inputs_of_stabilized_gate_.insert(mux->second.first.cbegin(), mux->second.first.cend());
+                    }
                 }
             }
 
             auto [node, ls] = part.leakref->leak_single();
-            database_[0][filtered_name].expr_ = node;
-            database_[0][filtered_name].leakset_ = ls;
+            database_[0][wire].expr_ = node;
+            database_[0][wire].leakset_ = ls;
         }
     }
 
-    // Retrospectively split exception signals, only valid for word verif
-    if (not config_.BIT_VERIF_) {
-        for (const auto& [signal, width] : config_.EXCEPTIONS_WORD_VERIF_) {
-        std::string filtered_name = signal;
-        std::replace(filtered_name.begin(), filtered_name.end(), '.', ' ');
-            bool is_input_of_stab_gate = inputs_of_stabilized_gate_.contains(filtered_name);
+    // Memory cells are verified in name order, a cell written twice keeps its last write
+    std::ranges::stable_sort(memory_cells, {}, [&](const auto& cell) -> const std::string& { return wires_.name(std::get<0>(cell)); });
+    for (const auto& [cell, curr, prev] : memory_cells) {
+        if (not database_memory_[0].empty() and database_memory_[0].back().first == cell) {
+            database_memory_[0].back().second = curr;
+            database_memory_[1].back().second = prev;
+        } else {
+            database_memory_[0].push_back({cell, curr});
+            database_memory_[1].push_back({cell, prev});
+        }
+    }
 
-            auto [node_to_split, ls_to_split] = dbg_items_.table[filtered_name].begin()->leakref->leak_single();
-            for (int i = 0; i < node_to_split->width / width; i++) {
-                int up_border = (((i+1)*width < node_to_split->width) ? (i+1)*width : node_to_split->width) - 1;
-                Node* node = &simplify(Extract(up_border, i*width, *node_to_split));
-                leaks::LeakSet* ls = leaks::extract(ls_to_split, i*width, up_border);
+    // Retrospectively split exception signals, only valid for word verif
+    for (const auto& split : split_exceptions_) {
+        bool is_input_of_stab_gate = inputs_of_stabilized_gate_.contains(split.signal_);
 
-                std::string split_name = std::string("split_exception_") + filtered_name + std::string("_") + std::to_string(i);
-                database_[0][split_name].expr_ = node;
-                database_[0][split_name].leakset_ = ls;
+        auto [node_to_split, ls_to_split] = split.part_->leakref->leak_single();
+        for (int i = 0; i < node_to_split->width / split.width_; i++) {
+            int up_border = (((i+1)*split.width_ < node_to_split->width) ? (i+1)*split.width_ : node_to_split->width) - 1;
+            Node* node = &simplify(Extract(up_border, i*split.width_, *node_to_split));
+            leaks::LeakSet* ls = leaks::extract(ls_to_split, i*split.width_, up_border);
 
-                // If this signal was added due to stability, add the split element
-                if (is_input_of_stab_gate)
-                    inputs_of_stabilized_gate_.insert(split_name);
-            }
+            database_[0][split.parts_.at(i)].expr_ = node;
+            database_[0][split.parts_.at(i)].leakset_ = ls;
 
-            // In case it was tagged for verif, remove it
-            inputs_of_stabilized_gate_.erase(filtered_name);
+            // If this signal was added due to stability, add the split element
+            if (is_input_of_stab_gate)
+                inputs_of_stabilized_gate_.insert(split.parts_.at(i));
         }
+
+        // In case it was tagged for verif, remove it
+        inputs_of_stabilized_gate_.erase(split.signal_);
     }
 
     std::cout << "Building database for cycle took " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin).count() << "ms." << std::endl;
 }
 
+// Cells are interned the first time they are written
+WireId Manager::memory_cell(WireId memory, size_t index) {
+    auto [it, inserted] = memory_cells_.try_emplace({memory, index}, 0);
+    if (inserted)
+        it->second = wires_.intern(std::string("mem_") + wires_.name(memory) + std::string("_") + std::to_string(index));
+    return it->second;
+}
+
+bool Manager::is_in_database(const std::string& wire) const {
+    return wires_.contains(wire) and wires_.id(wire) < database_[0].size();
+}
+
+// Memory cells are looked up in the memory database of the cycle
+Entry& Manager::database_entry(size_t cycle, const std::string& wire) {
+    if (this->is_in_database(wire))
+        return database_[cycle][wires_.id(wire)];
+
+    if (wires_.contains(wire)) {
+        WireId id = wires_.id(wire);
+        for (auto& [cell, entry] : database_memory_[cycle])
+            if (cell == id)
+                return entry;
+    }
+    throw std::out_of_range( "Wire not in database: " + wire );
+}
+
 bool Manager::verify() {
     if (config_.SKIP_VERIF_CYCLES_ > steps_) {
         std::cout << "Skipping cycle " << steps_ << "/" << config_.SKIP_VERIF_CYCLES_ << std::endl;
         return false;
     }
 
+    WireSet wires_elected_glitches = this->elect_wires_glitches();
+
+    std::cout << "Starting verif for cycle " << steps_ << std::endl;
+
+    std::vector<std::vector<Obligation>> phases = this->collect_obligations(wires_elected_glitches);
+
+    // With several jobs, the proofs needed by this cycle are performed by workers beforehand and
+    // land in cache, the sequential pass then decides on the same verdicts in the same order
+    this->prove_obligations(phases);
+
+    return this->conclude_verify(phases);
+}
+
+// Build the database of the cycle that was just evaluated and return the wires to verify with
+// glitches
+WireSet Manager::elect_wires_glitches() {
     // We will want to verify all the wires that applied stability previous cycle so keep them in memory
-    std::set<std::string> wires_elected_glitches = inputs_of_stabilized_gate_;
+    WireSet wires_elected_glitches = inputs_of_stabilized_gate_;
     std::cout << "Wires added to verif due to stability at previous cycle: " << wires_elected_glitches.size() << std::endl;
 
     // Add splited wires to verification everytime as they may cause local transitions
@@ -380,98 +581,35 @@ bool Manager::verify() {
     // Build the database for the current cycle
     this->build_database();
 
-    // When force verif all is set
-    if (config_.FORCE_VERIFY_ALL_) {
-        auto ks = std::views::keys(database_[0]);
-        wires_elected_glitches.insert(ks.begin(), ks.end());
-    }
-
-    // Add splitted wires for word verif
-    if (not config_.BIT_VERIF_)
-        wires_elected_glitches.insert(split_wires_.cbegin(), split_wires_.cend());
-
-    // Add registers and primary outputs
-    wires_elected_glitches.insert(registers_and_outputs_.cbegin(), registers_and_outputs_.cend());
+    // Add registers, primary outputs, splitted wires for word verif or all when forced
+    wires_elected_glitches |= always_elected_;
 
     // Add inputs of stabilized gates of current cycle (modified by build_database call
-    wires_elected_glitches.insert(inputs_of_stabilized_gate_.cbegin(), inputs_of_stabilized_gate_.cend());
+    wires_elected_glitches |= inputs_of_stabilized_gate_;
 
     std::cout << "Wires added to verif due to stability at previous cycle: " << inputs_of_stabilized_gate_.size() << std::endl;
     std::cout << "Wires added to verif in the end: " << wires_elected_glitches.size() << std::endl;
     std::cout << "SIZE OF DB ANYWAYS: " << database_[0].size() << std::endl;
 
-    std::cout << "Starting verif for cycle " << steps_ << std::endl;
-
-    std::set<std::string> vwog_leaking, twog_leaking, vwg_leaking, twg_leaking;
-
-    // For vwog, twog and twg (without over-approx), iterate over all database
-    if (config_.VERIF_VALUE_WO_GLITCHES_ or config_.VERIF_TRANSITION_WO_GLITCHES_ or
-        (config_.VERIF_TRANSITION_W_GLITCHES_ and not config_.TRANSITION_W_GLITCHES_OVER_APPROX_)) {
-        for (const auto& [name, entry] : database_[0]) {
-            if (config_.VERIF_VALUE_WO_GLITCHES_ and not this->is_secure_vwog(entry.expr_, entry.is_output_ ? 1 : 0)) {
-                vwog_leaking.insert(name);
-                if (config_.EXIT_AT_FIRST_LEAK_)
-                    break;
-            }
-
-            if (config_.VERIF_TRANSITION_WO_GLITCHES_ and not this->is_secure_twog(entry, database_[1][name])) {
-                twog_leaking.insert(name);
-                if (config_.EXIT_AT_FIRST_LEAK_)
-                    break;
-            }
+    return wires_elected_glitches;
+}
 
-            if ((config_.VERIF_TRANSITION_W_GLITCHES_ and not config_.TRANSITION_W_GLITCHES_OVER_APPROX_) and not this->is_secure_twg(entry, database_[1][name])) {
-                twg_leaking.insert(name);
-                if (config_.EXIT_AT_FIRST_LEAK_)
-                    break;
-            }
-        }
-    }
-    // For vwg and twg (with over-approx), iterate over flagged wires only
-    if (config_.VERIF_VALUE_W_GLITCHES_ or
-        (config_.VERIF_TRANSITION_W_GLITCHES_ and config_.TRANSITION_W_GLITCHES_OVER_APPROX_)) {
-        for (const auto& name : wires_elected_glitches) {
-            if (config_.VERIF_VALUE_W_GLITCHES_ and not this->is_secure_vwg(database_[0][name].leakset_, database_[0][name].is_output_ ? 1 : 0)) {
-                vwg_leaking.insert(name);
-                if (config_.EXIT_AT_FIRST_LEAK_)
-                    break;
-            }
+// Decide on the obligations of the cycle and report its leaks
+bool Manager::conclude_verify(const std::vector<std::vector<Obligation>>& phases) {
+    std::array<std::set<std::string>, 4> leaking;
+    auto& [vwog_leaking, twog_leaking, vwg_leaking, twg_leaking] = leaking;
 
-            if ((config_.VERIF_TRANSITION_W_GLITCHES_ and config_.TRANSITION_W_GLITCHES_OVER_APPROX_) and not this->is_secure_twg(database_[0][name], database_[1][name])) {
-                twg_leaking.insert(name);
+    // Exiting at first leak only ends the current phase, as it always did
+    for (const auto& phase : phases) {
+        for (const auto& obligation : phase) {
+            if (not this->is_secure(obligation)) {
+                leaking[obligation.kind_].insert(wires_.name(obligation.wire_));
                 if (config_.EXIT_AT_FIRST_LEAK_)
                     break;
             }
         }
     }
 
-    // Verify memories
-    for (const auto& [name, entry] : database_memory_[0]) {
-        if (config_.VERIF_VALUE_WO_GLITCHES_ and not this->is_secure_vwog(entry.expr_, entry.is_output_ ? 1 : 0)) {
-            vwog_leaking.insert(name);
-            if (config_.EXIT_AT_FIRST_LEAK_)
-                break;
-        }
-
-        if (config_.VERIF_TRANSITION_WO_GLITCHES_ and not this->is_secure_twog(entry, database_memory_[1][name])) {
-            twog_leaking.insert(name);
-            if (config_.EXIT_AT_FIRST_LEAK_)
-                break;
-        }
-
-        if (config_.VERIF_VALUE_W_GLITCHES_ and not this->is_secure_vwg(entry.leakset_, entry.is_output_ ? 1 : 0)) {
-            vwg_leaking.insert(name);
-            if (config_.EXIT_AT_FIRST_LEAK_)
-                break;
-        }
-
-        if (config_.VERIF_TRANSITION_W_GLITCHES_ and not this->is_secure_twg(entry, database_memory_[1][name])) {
-            twg_leaking.insert(name);
-            if (config_.EXIT_AT_FIRST_LEAK_)
-                break;
-        }
-    }
-
     // Now plot all graphs
 //    for (auto& leak : vwog_leaking)
 //        std::cout << "Leak by value without glitch on : " << leak << std::endl;
@@ -536,6 +674,199 @@ bool Manager::verify() {
     return (leaks_nb == 0);
 }
 
+// List the obligations of the current cycle, grouped in phases: the whole database, the wires
+// elected for glitch verification and the memories. The order within a phase is the verification
+// order, it is the one that matters when exiting at first leak.
+std::vector<std::vector<Obligation>> Manager::collect_obligations(const WireSet& wires_elected_glitches) {
+    std::vector<std::vector<Obligation>> phases(3);
+
+    // For vwog, twog and twg (without over-approx), iterate over all database
+    if (config_.VERIF_VALUE_WO_GLITCHES_ or config_.VERIF_TRANSITION_WO_GLITCHES_ or
+        (config_.VERIF_TRANSITION_W_GLITCHES_ and not config_.TRANSITION_W_GLITCHES_OVER_APPROX_)) {
+        for (WireId wire = 0; wire < database_[0].size(); ++wire) {
+            if (config_.VERIF_VALUE_WO_GLITCHES_)
+                phases[0].push_back({Obligation::VWOG, wire, &database_[0][wire], nullptr});
+            if (config_.VERIF_TRANSITION_WO_GLITCHES_)
+                phases[0].push_back({Obligation::TWOG, wire, &database_[0][wire], &database_[1][wire]});
+            if (config_.VERIF_TRANSITION_W_GLITCHES_ and not config_.TRANSITION_W_GLITCHES_OVER_APPROX_)
+                phases[0].push_back({Obligation::TWG, wire, &database_[0][wire], &database_[1][wire]});
+        }
+    }
+
+    // For vwg and twg (with over-approx), iterate over flagged wires only
+    if (config_.VERIF_VALUE_W_GLITCHES_ or
+        (config_.VERIF_TRANSITION_W_GLITCHES_ and config_.TRANSITION_W_GLITCHES_OVER_APPROX_)) {
+        // Wires only known from the topology have nothing to verify
+        wires_elected_glitches.for_each(database_[0].size(), [&](WireId wire) {
+            if (config_.VERIF_VALUE_W_GLITCHES_)
+                phases[1].push_back({Obligation::VWG, wire, &database_[0][wire], nullptr});
+            if (config_.VERIF_TRANSITION_W_GLITCHES_ and config_.TRANSITION_W_GLITCHES_OVER_APPROX_)
+                phases[1].push_back({Obligation::TWG, wire, &database_[0][wire], &database_[1][wire]});
+        });
+    }
+
+    // Verify memories, both cycles hold the same cells
+    for (size_t i = 0; i < database_memory_[0].size(); ++i) {
+        const auto& [cell, entry] = database_memory_[0][i];
+        if (config_.VERIF_VALUE_WO_GLITCHES_)
+            phases[2].push_back({Obligation::VWOG, cell, &entry, nullptr});
+        if (config_.VERIF_TRANSITION_WO_GLITCHES_)
+            phases[2].push_back({Obligation::TWOG, cell, &entry, &database_memory_[1][i].second});
+        if (config_.VERIF_VALUE_W_GLITCHES_)
+            phases[2].push_back({Obligation::VWG, cell, &entry, nullptr});
+        if (config_.VERIF_TRANSITION_W_GLITCHES_)
+            phases[2].push_back({Obligation::TWG, cell, &entry, &database_memory_[1][i].second});
+    }
+
+    return phases;
+}
+
+// Dispatch the proofs of the obligations to the prover pool, verdicts are then stored in cache.
+void Manager::prove_obligations(const std::vector<std::vector<Obligation>>& phases) {
+    // SNI verdicts depend on the outputs of each tuple, only the sequential pass knows them
+    if (prover_pool_.workers() <= 1 or config_.SECURITY_PROPERTY_ == leaks::Properties::SNI)
+        return;
+
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+    ProofJobs proofs = this->gather_proofs(phases);
+    std::vector<bool> verdicts = prover_pool_.run(proofs.size(), [&](size_t i) { return this->prove(proofs, i); });
+    this->store_proofs(proofs, verdicts);
+
+    std::cout << "Proving " << proofs.size() << " obligations with " << prover_pool_.workers() << " jobs took " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin).count() << "ms." << std::endl;
+}
+
+// Gather every proof the obligations would trigger, that is neither trivial nor in cache
+ProofJobs Manager::gather_proofs(const std::vector<std::vector<Obligation>>& phases) {
+    ProofJobs proofs;
+    // SNI verdicts depend on the outputs of each tuple, only the sequential pass knows them
+    if (config_.SECURITY_PROPERTY_ == leaks::Properties::SNI)
+        return proofs;
+
+    std::set<Node*> known_nodes;
+    std::set<std::set<Node*>> known_sets;
+
+    auto add_node = [&](Node* node, Obligation::Kind kind) {
+        if (cache_.is_node_trivial(node) or cache_.contains_node(node) or known_nodes.contains(node))
+            return;
+        known_nodes.insert(node);
+        proofs.nodes_.push_back({node, kind});
+    };
+    auto add_sets = [&](const std::vector<std::set<Node*>>& glitch_sets, Obligation::Kind kind) {
+        for (const auto& set : glitch_sets) {
+            if (cache_.is_set_trivial(set) or cache_.contains_set(set) or known_sets.contains(set))
+                continue;
+            known_sets.insert(set);
+            proofs.sets_.push_back({set, kind});
+        }
+    };
+
+    for (const auto& phase : phases) {
+        for (const auto& obligation : phase) {
+            const Entry& curr = *obligation.curr_;
+            switch (obligation.kind_) {
+                case Obligation::VWOG:
+                    add_node(curr.expr_, obligation.kind_);
+                    break;
+                case Obligation::TWOG:
+                    if (obligation.prev_->expr_ == nullptr or (curr.expr_->nature == CONST and obligation.prev_->expr_->nature == CONST))
+                        break;
+                    add_node(this->transition_node(curr.expr_, obligation.prev_->expr_), obligation.kind_);
+                    break;
+                case Obligation::VWG:
+                    add_sets(this->glitch_sets(curr.leakset_, nullptr), obligation.kind_);
+                    break;
+                case Obligation::TWG:
+                    add_sets(this->glitch_sets(curr.leakset_, (config_.TRANSITION_W_GLITCHES_OVER_APPROX_) ?
+                        obligation.prev_->leakset_ : leaks::reg_stabilize(obligation.prev_->expr_)), obligation.kind_);
+                    break;
+            }
+        }
+    }
+
+    return proofs;
+}
+
+// Output counting is only relevant for SNI, which is never gathered
+bool Manager::prove(const ProofJobs& proofs, size_t index) const {
+    if (index < proofs.nodes_.size()) {
+        if (config_.BIT_VERIF_)
+            return leaks::symb_verify_without_glitch_bit(proofs.nodes_[index].first, config_.REMOVE_FALSE_NEGATIVE_, config_.SECURITY_PROPERTY_, order_, 0);
+        return leaks::symb_verify_without_glitch(proofs.nodes_[index].first, config_.REMOVE_FALSE_NEGATIVE_, config_.SECURITY_PROPERTY_, order_, 0);
+    }
+    return leaks::symb_verify_with_glitch(proofs.sets_[index - proofs.nodes_.size()].first, config_.REMOVE_FALSE_NEGATIVE_, config_.SECURITY_PROPERTY_, order_, 0);
+}
+
+// Account proofs where the sequential verification would have, it will only hit cache now
+void Manager::store_proofs(const ProofJobs& proofs, const std::vector<bool>& verdicts) {
+    for (size_t i = 0; i < proofs.nodes_.size(); ++i) {
+        cache_.add_node_to_cache(proofs.nodes_[i].first, verdicts[i]);
+        ++((proofs.nodes_[i].second == Obligation::VWOG) ? verified_VWOG_ : verified_TWOG_);
+    }
+    for (size_t i = 0; i < proofs.sets_.size(); ++i) {
+        cache_.add_set_to_cache(proofs.sets_[i].first, verdicts[proofs.nodes_.size() + i]);
+        ++((proofs.sets_[i].second == Obligation::VWG) ? verified_VWG_ : verified_TWG_);
+    }
+}
+
+// Start the proofs of the cycle that was just evaluated in background. The cycle is concluded by
+// retire_verifications() once its workers are done.
+void Manager::schedule_verify() {
+    WireSet wires_elected_glitches = this->elect_wires_glitches();
+
+    std::cout << "Scheduling verif for cycle " << steps_ << std::endl;
+
+    ProofJobs proofs = this->gather_proofs(this->collect_obligations(wires_elected_glitches));
+    pending_cycles_.push_back({steps_, database_, database_memory_, std::move(wires_elected_glitches), std::move(proofs), {}});
+
+    // Workers get a snapshot of the process when forked, proofs only need to outlive the launch
+    PendingCycle& pending = pending_cycles_.back();
+    pending.batch_ = prover_pool_.launch(pending.proofs_.size(), [&](size_t i) { return this->prove(pending.proofs_, i); });
+
+    std::cout << "Pending cycles: " << pending_cycles_.size() << ", proofs in background: " << pending.proofs_.size() << std::endl;
+}
+
+// Conclude the oldest pending cycles until at most max_pending remain. Return false if the
+// simulation must stop due to a leak, the remaining pending cycles are then cancelled.
+bool Manager::retire_verifications(size_t max_pending) {
+    while (pending_cycles_.size() > max_pending) {
+        PendingCycle pending = std::move(pending_cycles_.front());
+        pending_cycles_.pop_front();
+
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        std::vector<bool> verdicts = prover_pool_.collect(pending.batch_);
+        std::cout << "Waiting for verif of cycle " << pending.step_ << " took " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin).count() << "ms." << std::endl;
+
+        // Step back to the pending cycle for the sequential pass and the report
+        std::swap(database_, pending.database_);
+        std::swap(database_memory_, pending.database_memory_);
+        std::swap(steps_, pending.step_);
+
+        this->store_proofs(pending.proofs_, verdicts);
+        bool is_secure = this->conclude_verify(this->collect_obligations(pending.wires_elected_glitches_));
+
+        std::swap(database_, pending.database_);
+        std::swap(database_memory_, pending.database_memory_);
+        std::swap(steps_, pending.step_);
+
+        if (not is_secure) {
+            std::cout << "Leaks found in simulation step " << pending.step_ << std::endl;
+            ++leaking_cycles_;
+            if (config_.EXIT_AT_FIRST_LEAK_ or config_.EXIT_AT_FIRST_LEAKING_CYCLE_) {
+                this->cancel_verifications();
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void Manager::cancel_verifications() {
+    for (auto& pending : pending_cycles_)
+        prover_pool_.cancel(pending.batch_);
+    pending_cycles_.clear();
+}
+
 bool Manager::verify_higher_order() {
     if (config_.SKIP_VERIF_CYCLES_ > steps_) {
         std::cout << "Skipping cycle " << steps_ << "/" << config_.SKIP_VERIF_CYCLES_ << std::endl;
@@ -545,8 +876,12 @@ bool Manager::verify_higher_order() {
     // Build the database for the current cycle
     this->build_database();
     // TODO: The database does not handle memories for higher order for now, it must be adressed before implementing HO for CPUs
-    // Store the new cycle in database (database[0] can still be refered to as the last computed cycle)
-    this->database_ho_.push_back(this->database_[0]);
+    // Store the new cycle in history (database[0] can still be refered to as the last computed cycle)
+    if (config_.HIGHER_ORDER_TYPE_ == Configuration::TEMPORAL) {
+        bool bit_nodes = config_.BIT_VERIF_ and config_.VERIF_VALUE_WO_GLITCHES_;
+        this->history_ho_.push({this->slice(this->database_[0], false, not bit_nodes and config_.VERIF_VALUE_WO_GLITCHES_, config_.VERIF_VALUE_W_GLITCHES_),
+            (bit_nodes) ? this->slice(this->database_[0], true, true, false) : Slices{}});
+    }
 
     // When higher order is considered verif by value (with and without glitch) make sense trivially
     // For spatial: all combinations (eventually at bit level) of n-uplets of the current cycle (DO WE CONSIDER TRANSITIONS ?)
@@ -564,132 +899,358 @@ bool Manager::verify_higher_order() {
 }
 
 bool Manager::verify_higher_order_spatial() {
-    std::set<std::string> vwog_leaking, vwg_leaking;
-    // The way to generate the combinations is slightly different between BIT and WORD verif
-    // For the former, we must iterate through the elements and generate as much combinations as
-    // there are bits for this wire
-    // For WORD verification, we simply generate the combinations without duplicates
+    // The members of the tuples are slightly different between BIT and WORD verif
+    // For the former, bits of a wire must be verified against each other and all other wires
+    // So we add a new dimension by considering all bits of wires independently
+    // For WORD verification, we simply combine the wires without duplicates
+    // Spatial works on the freshly computed cycle only, members are sliced once for all tuples
+    Slices slices = this->slice(database_[0], config_.BIT_VERIF_, config_.VERIF_VALUE_WO_GLITCHES_, config_.VERIF_VALUE_W_GLITCHES_);
+
+    // A tuple whose members depend on no secret cannot leak. Slots with a secret come first, such
+    // tuples are then exactly the last ranks of the enumeration, which is cut before them.
+    size_t with_secret = slices.size();
+    if (SupportTable* supports = cache_.supports(); supports != nullptr)
+        with_secret = this->order_by_secret(slices, *supports);
+
+    // A sweep verifies every order up to the requested one on the same slices. Under TPS, a tuple
+    // containing a leaking tuple of a lower order leaks as well, it is not proven again.
+    std::set<std::vector<uint32_t>> leaking_tuples;
+    bool propagate = config_.ORDER_SWEEP_ and config_.SECURITY_PROPERTY_ == leaks::Properties::TPS;
+
+    bool is_secure = true;
+    for (order_ = (config_.ORDER_SWEEP_) ? 1 : config_.ORDER_VERIF_; order_ <= config_.ORDER_VERIF_; ++order_) {
+        bool order_secure = this->verify_spatial_order(slices, with_secret, (propagate) ? &leaking_tuples : nullptr);
+        if (config_.ORDER_SWEEP_)
+            std::cout << "Order " << order_ << ((order_secure) ? " secure" : " leaking") << std::endl;
+        is_secure &= order_secure;
+        if (not order_secure and config_.EXIT_AT_FIRST_LEAK_)
+            break;
+    }
+    order_ = config_.ORDER_VERIF_;
 
-    // Spatial works on the freshly computed cycle only
-    auto ks = std::views::keys(database_[0]);
-    std::vector<std::string> keys{ ks.begin(), ks.end() };
+    return is_secure;
+}
 
-    if (config_.BIT_VERIF_) {
-        std::vector<std::pair<std::string, unsigned int>> keys_with_dups;
-
-        // if we are performing bit-level verification, we need to take into account
-        // that bits of a wire must be verified against each other and all other wires
-        // So we add a new dimension by considering all bits of wires independently
-        for (const auto& [name, entry] : database_[0])
-            for (int i = 0; i < entry.expr_->width; ++i)
-                keys_with_dups.push_back({name, i});
-
-        // With duplicatas (usefull for bit verif)
-        int n = keys_with_dups.size();
-        int r = config_.ORDER_VERIF_;
-        std::cout << "Combination of " << r << " among " << n << std::endl;
-        std::vector<bool> v(n);
-        std::fill(v.end() - r, v.end(), true);
-        std::vector<std::pair<Entry, unsigned int>> combination;
-        combination.reserve(r);
-
-        do {
-            combination.clear();
-            // Two different bits of the same output wire are considered two outputs in bit-verif
-            int outputs = 0;
-            for (int i = 0; i < n; ++i) {
-                if (v[i]) {
-                    //std::cout << keys_with_dups[i].first << "[" << keys_with_dups[i].second << "], ";
-                    //std::cout << i << " ";
-                    combination.push_back({database_[0][keys_with_dups[i].first], keys_with_dups[i].second});
-                    if (database_[0][keys_with_dups[i].first].is_output_)
-                        ++outputs;
-                }
-            }
-            //std::cout << "\n";
-            // Now verify the built combination while taking care of the bit to handle for each Entry
-            if (config_.VERIF_VALUE_WO_GLITCHES_) {
-                std::vector<Node*> accumulate_verif_nodes;
-                for (const auto& entry: combination)
-                    accumulate_verif_nodes.push_back(&simplify(Extract(entry.second, entry.second, *entry.first.expr_)));
+// Words at the beginning of the result of a chunk: its verdict, the number of tuples leaking without
+// proof, the number of leaking tuples recorded, then the statistics added by a forked worker. The
+// members of the leaking tuples follow, then the verdicts proven by a forked worker.
+namespace ChunkWord {
+    enum : size_t {
+        VERDICT, INHERITED, LEAKING,
+        TOTAL_VWOG, VERIFIED_VWOG, TOTAL_VWG, VERIFIED_VWG,
+        HITS_NODES, HITS_SETS, MISSES_SETS, TRIVIAL_NODES, TRIVIAL_SETS,
+        HEADER
+    };
+}
 
-                Node* to_verif = &Concat(accumulate_verif_nodes);
+// Verifies all the tuples of the current order. Leaking tuples are added to leaking_tuples when
+// given, tuples containing one of them are leaking without proof.
+bool Manager::verify_spatial_order(const Slices& slices, size_t with_secret, std::set<std::vector<uint32_t>>* leaking_tuples) {
+    // Tuples are ranked so that the enumeration is split in chunks of consecutive ranks, proven by
+    // the prover pool. Each worker verifies with its own copy of the cache and sends back the
+    // verdicts it proved and its statistics.
+    uint32_t n = slices.size();
+    uint32_t r = order_;
+    uint64_t pruned = combinations::binomial(n - with_secret, r);
+    uint64_t total = combinations::binomial(n, r) - pruned;
+    pruned_tuples_ += pruned;
+    enumerated_tuples_ += total;
+
+    uint64_t chunk_size = config_.HO_CHUNK_SIZE_;
+    size_t chunks = total / chunk_size + (total % chunk_size != 0);
+    std::cout << "Combination of " << r << " among " << n << " in " << chunks << " chunks, " << pruned << " tuples without secret pruned" << std::endl;
+
+    // Forked workers only send back verdicts on nodes of the parent, the leaksets of the members
+    // are computed before forking (their merges only unite them)
+    pid_t parent = getpid();
+    if (prover_pool_.workers() > 1 and chunks > 1)
+        for (leaks::LeakSet* ls : slices.leaksets_)
+            if (ls != nullptr)
+                ls->leaks.vector();
+
+    SharedFlag leak_found;
+    uint64_t content = (checkpoint_) ? this->slices_key(slices, with_secret) : 0;
+    std::vector<std::string> results = prover_pool_.map(chunks, [&](size_t chunk) {
+        std::vector<uint32_t> words(ChunkWord::HEADER, 0);
+        words[ChunkWord::VERDICT] = 1;
+        ChunkCheckpoint::Chunk id{};
+        if (checkpoint_) {
+            id = checkpoint_->chunk(content, steps_, n, r, chunk_size, chunk);
+            if (checkpoint_->is_done(id))
+                return std::string(reinterpret_cast<const char*>(words.data()), words.size() * sizeof(uint32_t));
+        }
 
-                // Here it is ok to use is_secure even in BIT mode only because in higher order case, the method
-                // does not verify by bit but by word (here only containing needed bits)
-                if (not this->is_secure_vwog(to_verif, outputs)) {
-                    vwog_leaking.insert("TODO");
-                    if (config_.EXIT_AT_FIRST_LEAK_)
-                        break;
-                }
+        // What a forked worker learns is lost when it exits, unless it is sent back
+        bool forked = getpid() != parent;
+        std::array<unsigned int, 4> manager_start{total_VWOG_, verified_VWOG_, total_VWG_, verified_VWG_};
+        Cache::Counters cache_start = cache_.counters();
+        std::vector<uint32_t> proofs;
+
+        uint64_t begin = chunk * chunk_size;
+        bool is_secure = this->verify_spatial_chunk(slices, r, begin, std::min(total, begin + chunk_size), leak_found, leaking_tuples,
+            words, (forked) ? &proofs : nullptr);
+        words[ChunkWord::VERDICT] = is_secure;
+        words[ChunkWord::LEAKING] = (words.size() - ChunkWord::HEADER) / r;
+        if (forked) {
+            Cache::Counters cache_end = cache_.counters();
+            words[ChunkWord::TOTAL_VWOG] = total_VWOG_ - manager_start[0];
+            words[ChunkWord::VERIFIED_VWOG] = verified_VWOG_ - manager_start[1];
+            words[ChunkWord::TOTAL_VWG] = total_VWG_ - manager_start[2];
+            words[ChunkWord::VERIFIED_VWG] = verified_VWG_ - manager_start[3];
+            words[ChunkWord::HITS_NODES] = cache_end.hits_nodes_ - cache_start.hits_nodes_;
+            words[ChunkWord::HITS_SETS] = cache_end.hits_sets_ - cache_start.hits_sets_;
+            words[ChunkWord::MISSES_SETS] = cache_end.misses_sets_ - cache_start.misses_sets_;
+            words[ChunkWord::TRIVIAL_NODES] = cache_end.trivial_nodes_ - cache_start.trivial_nodes_;
+            words[ChunkWord::TRIVIAL_SETS] = cache_end.trivial_sets_ - cache_start.trivial_sets_;
+            words.insert(words.end(), proofs.begin(), proofs.end());
+        }
+
+        // A chunk interrupted by a leak found elsewhere is not complete
+        if (checkpoint_ and is_secure and not leak_found.is_set())
+            checkpoint_->record(id);
+        if (chunks > 1)
+            std::cout << "Chunk " << chunk + 1 << "/" << chunks << ((is_secure) ? " secure" : " leaking") << std::endl;
+        return std::string(reinterpret_cast<const char*>(words.data()), words.size() * sizeof(uint32_t));
+    });
+
+    bool is_secure = true;
+    std::vector<std::vector<uint32_t>> found;
+    for (const auto& result : results) {
+        std::vector<uint32_t> words(result.size() / sizeof(uint32_t));
+        std::memcpy(words.data(), result.data(), words.size() * sizeof(uint32_t));
+        is_secure &= words[ChunkWord::VERDICT] != 0;
+        inherited_leaks_ += words[ChunkWord::INHERITED];
+        size_t proofs = ChunkWord::HEADER + words[ChunkWord::LEAKING] * r;
+        for (size_t i = ChunkWord::HEADER; i < proofs; i += r)
+            found.emplace_back(words.begin() + i, words.begin() + i + r);
+
+        total_VWOG_ += words[ChunkWord::TOTAL_VWOG];
+        verified_VWOG_ += words[ChunkWord::VERIFIED_VWOG];
+        total_VWG_ += words[ChunkWord::TOTAL_VWG];
+        verified_VWG_ += words[ChunkWord::VERIFIED_VWG];
+        cache_.add_counters({words[ChunkWord::HITS_NODES], words[ChunkWord::HITS_SETS], words[ChunkWord::MISSES_SETS],
+            words[ChunkWord::TRIVIAL_NODES], words[ChunkWord::TRIVIAL_SETS]});
+        this->store_chunk_proofs(slices, r, words, proofs);
+    }
+    // Only added now, the chunks of this order must not see each other tuples
+    if (leaking_tuples != nullptr)
+        leaking_tuples->insert(found.begin(), found.end());
+
+    return is_secure;
+}
+
+// Verdicts proven by a forked worker, recorded per tuple: the members, the verdict of the node (0
+// when not proven, 1 when leaking, 2 when secure), the number of sets then each set as its size,
+// the addresses of its nodes and its verdict. The node of the tuple is built again here, the
+// nodes of the sets already existed before forking.
+void Manager::store_chunk_proofs(const Slices& slices, uint32_t r, const std::vector<uint32_t>& words, size_t begin) {
+    // Same bounds as is_secure_vwog() and is_secure_vwg()
+    bool bounded = config_.SECURITY_PROPERTY_ == leaks::Properties::SNI or (config_.SECURITY_PROPERTY_ == leaks::Properties::NI and config_.ORDER_SWEEP_);
+    std::vector<Node*> accumulate_verif_nodes;
+    size_t i = begin;
+    while (i < words.size()) {
+        std::vector<uint32_t> tuple(words.begin() + i, words.begin() + i + r);
+        i += r;
+        int outputs = 0;
+        for (uint32_t member : tuple)
+            if (database_[0][slices.wires_[member]].is_output_)
+                ++outputs;
+        int bound = static_cast<int>(order_) - ((config_.SECURITY_PROPERTY_ == leaks::Properties::SNI) ? outputs : 0);
+
+        if (uint32_t node_verdict = words[i++]; node_verdict != 0) {
+            accumulate_verif_nodes.clear();
+            for (uint32_t member : tuple)
+                accumulate_verif_nodes.push_back(slices.nodes_[member]);
+            Node* node = &Concat(accumulate_verif_nodes);
+            if (bounded)
+                cache_.add_node_to_cache(node, bound, node_verdict == 2);
+            else
+                cache_.add_node_to_cache(node, node_verdict == 2);
+        }
+
+        uint32_t sets = words[i++];
+        for (uint32_t s = 0; s < sets; ++s) {
+            std::set<Node*> set;
+            uint32_t size = words[i++];
+            for (uint32_t k = 0; k < size; ++k, i += 2)
+                set.insert(reinterpret_cast<Node*>((static_cast<uint64_t>(words[i]) << 32) | words[i + 1]));
+            bool verdict = words[i++] != 0;
+            if (bounded)
+                cache_.add_set_to_cache(set, bound, verdict);
+            else
+                cache_.add_set_to_cache(set, verdict);
+        }
+    }
+}
+
+// Whether a proper subset of the (sorted) tuple is a known leaking tuple
+static bool contains_leaking(const std::vector<uint32_t>& tuple, const std::set<std::vector<uint32_t>>& leaking_tuples) {
+    std::vector<uint32_t> subset;
+    for (uint32_t mask = 1; mask + 1 < (1u << tuple.size()); ++mask) {
+        subset.clear();
+        for (size_t i = 0; i < tuple.size(); ++i)
+            if ((mask >> i) & 1)
+                subset.push_back(tuple[i]);
+        if (leaking_tuples.contains(subset))
+            return true;
+    }
+    return false;
+}
+
+// Verifies the tuples of ranks [begin, end), stops all the chunks at the first leak if asked to.
+// The number of tuples leaking through leaking_tuples and the new leaking tuples are appended to
+// words when recording. The verdicts proven are appended to proofs when given, as read by
+// store_chunk_proofs().
+bool Manager::verify_spatial_chunk(const Slices& slices, uint32_t r, uint64_t begin, uint64_t end, const SharedFlag& leak_found,
+        const std::set<std::vector<uint32_t>>* leaking_tuples, std::vector<uint32_t>& words, std::vector<uint32_t>* proofs) {
+    bool is_secure = true;
+    std::vector<uint32_t> tuple = combinations::unrank(begin, slices.size(), r);
+    std::vector<Node*> accumulate_verif_nodes;
+    std::vector<leaks::LeakSet*> accumulate_lss;
+    std::vector<std::pair<std::set<Node*>, bool>> proven_sets;
+
+    for (uint64_t rank = begin; rank < end and not leak_found.is_set(); ++rank, combinations::next(tuple, slices.size())) {
+        if (leaking_tuples != nullptr and not leaking_tuples->empty() and contains_leaking(tuple, *leaking_tuples)) {
+            ++words[ChunkWord::INHERITED];
+            is_secure = false;
+            if (config_.EXIT_AT_FIRST_LEAK_) {
+                leak_found.set();
+                break;
             }
-            if (config_.VERIF_VALUE_W_GLITCHES_) {
-                std::vector<leaks::LeakSet*> accumulate_lss;
-                for (const auto& entry: combination)
-                    accumulate_lss.push_back(leaks::extract(entry.first.leakset_, entry.second, entry.second));
+            continue;
+        }
 
-                leaks::LeakSet* to_verif = leaks::merge(accumulate_lss);
+        // Two different bits of the same output wire are considered two outputs in bit-verif
+        int outputs = 0;
+        for (uint32_t member : tuple)
+            if (database_[0][slices.wires_[member]].is_output_)
+                ++outputs;
+
+        bool tuple_secure = true;
+        uint32_t node_verdict = 0;
+        if (config_.VERIF_VALUE_WO_GLITCHES_) {
+            accumulate_verif_nodes.clear();
+            for (uint32_t member : tuple)
+                accumulate_verif_nodes.push_back(slices.nodes_[member]);
+
+            // Here it is ok to use is_secure even in BIT mode only because in higher order case, the method
+            // does not verify by bit but by word (here only containing needed bits)
+            unsigned int verified = verified_VWOG_;
+            tuple_secure = this->is_secure_vwog(&Concat(accumulate_verif_nodes), outputs);
+            if (verified_VWOG_ != verified)
+                node_verdict = 1 + tuple_secure;
+        }
+        proven_sets.clear();
+        if (config_.VERIF_VALUE_W_GLITCHES_ and (tuple_secure or not config_.EXIT_AT_FIRST_LEAK_)) {
+            accumulate_lss.clear();
+            for (uint32_t member : tuple)
+                accumulate_lss.push_back(slices.leaksets_[member]);
+
+            // Here it is ok to use is_secure even in BIT mode as the leaksets are merged (one line containing all)
+            tuple_secure &= this->is_secure_vwg(leaks::merge(accumulate_lss), outputs, (proofs != nullptr) ? &proven_sets : nullptr);
+        }
 
-                // Here it is ok to use is_secure even in BIT mode as the leaksets are merged (one line containing all)
-                if (not this->is_secure_vwg(to_verif, outputs)) {
-                    vwg_leaking.insert("TODO");
-                    if (config_.EXIT_AT_FIRST_LEAK_)
-                        break;
+        if (proofs != nullptr and (node_verdict != 0 or not proven_sets.empty())) {
+            proofs->insert(proofs->end(), tuple.begin(), tuple.end());
+            proofs->push_back(node_verdict);
+            proofs->push_back(proven_sets.size());
+            for (const auto& [set, verdict] : proven_sets) {
+                proofs->push_back(set.size());
+                for (Node* node : set) {
+                    uint64_t address = reinterpret_cast<uint64_t>(node);
+                    proofs->push_back(address >> 32);
+                    proofs->push_back(address & 0xFFFFFFFFu);
                 }
+                proofs->push_back(verdict);
             }
-        } while (std::next_permutation(v.begin(), v.end()));
-    } else {
-        // We only need to match each wire against all other wires without dupllicata when verifying words
-        int n = keys.size();
-        int r = config_.ORDER_VERIF_;
-        std::vector<bool> v(n);
-        std::fill(v.end() - r, v.end(), true);
-        std::vector<Entry> combination;
-        combination.reserve(r);
-
-        do {
-            combination.clear();
-            // Wires are not combined with themselves so counting the number of outputs is valid
-            int outputs = 0;
-            for (int i = 0; i < n; ++i) {
-                if (v[i]) {
-                    //std::cout << i << " ";
-                    //std::cout << keys[i] << ", ";
-                    combination.push_back(database_[0][keys[i]]);
-                    if (database_[0][keys[i]].is_output_)
-                        ++outputs;
-                }
+        }
+
+        if (not tuple_secure) {
+            is_secure = false;
+            if (leaking_tuples != nullptr)
+                words.insert(words.end(), tuple.begin(), tuple.end());
+            if (config_.EXIT_AT_FIRST_LEAK_) {
+                leak_found.set();
+                break;
             }
-            //std::cout << "\n";
-            if (config_.VERIF_VALUE_WO_GLITCHES_) {
-                std::vector<Node*> accumulate_verif_nodes;
-                for (const auto& entry: combination)
-                    accumulate_verif_nodes.push_back(entry.expr_);
+        }
+    }
 
-                Node* to_verif = &Concat(accumulate_verif_nodes);
+    return is_secure;
+}
 
-                if (not this->is_secure_vwog(to_verif, outputs)) {
-                    vwog_leaking.insert("TODO");
-                    if (config_.EXIT_AT_FIRST_LEAK_)
-                        break;
-                }
-            }
-            if (config_.VERIF_VALUE_W_GLITCHES_) {
-                std::vector<leaks::LeakSet*> accumulate_lss;
-                for (const auto& entry: combination)
-                    accumulate_lss.push_back(entry.leakset_);
+Slices Manager::slice(const std::vector<Entry>& database, bool per_bit, bool nodes, bool leaksets) const {
+    Slices slices;
+    slices.offsets_.reserve(database.size());
+    for (WireId wire = 0; wire < database.size(); ++wire) {
+        const Entry& entry = database[wire];
+        slices.offsets_.push_back(slices.size());
+        if (not per_bit) {
+            slices.wires_.push_back(wire);
+            if (nodes)
+                slices.nodes_.push_back(entry.expr_);
+            if (leaksets)
+                slices.leaksets_.push_back(entry.leakset_);
+            continue;
+        }
+        for (int bit = 0; bit < entry.expr_->width; ++bit) {
+            slices.wires_.push_back(wire);
+            if (nodes)
+                slices.nodes_.push_back(leaks::bit(entry.expr_, bit));
+            if (leaksets)
+                slices.leaksets_.push_back(leaks::extract(entry.leakset_, bit, bit));
+        }
+    }
+    return slices;
+}
 
-                leaks::LeakSet* to_verif = leaks::merge(accumulate_lss);
+// Stable partition of the slots, those depending on a secret first. Returns their number.
+size_t Manager::order_by_secret(Slices& slices, SupportTable& supports) const {
+    auto has_secret = [&](size_t slot) {
+        if (not slices.nodes_.empty() and supports.has_secret(slices.nodes_[slot]))
+            return true;
+        if (not slices.leaksets_.empty())
+            for (Node* node : leaks::flatten(slices.leaksets_[slot]))
+                if (supports.has_secret(node))
+                    return true;
+        return false;
+    };
+
+    std::vector<size_t> order(slices.size());
+    std::iota(order.begin(), order.end(), 0);
+    auto middle = std::stable_partition(order.begin(), order.end(), has_secret);
+
+    Slices ordered;
+    for (size_t slot : order) {
+        ordered.wires_.push_back(slices.wires_[slot]);
+        if (not slices.nodes_.empty())
+            ordered.nodes_.push_back(slices.nodes_[slot]);
+        if (not slices.leaksets_.empty())
+            ordered.leaksets_.push_back(slices.leaksets_[slot]);
+    }
+    slices = std::move(ordered);
+    return middle - order.begin();
+}
 
-                if (not this->is_secure_vwg(to_verif, outputs)) {
-                    vwg_leaking.insert("TODO");
-                    if (config_.EXIT_AT_FIRST_LEAK_)
-                        break;
-                }
-            }
-        } while (std::next_permutation(v.begin(), v.end()));
+// Structural key of the members of the tuples, so that a checkpoint only resumes the enumeration
+// of the same expressions
+uint64_t Manager::slices_key(const Slices& slices, size_t with_secret) {
+    std::vector<uint64_t> words{slices.size(), with_secret};
+    auto absorb = [&](const Fingerprint& key) {
+        words.push_back(key.high_);
+        words.push_back(key.low_);
+    };
+    for (size_t slot = 0; slot < slices.size(); ++slot) {
+        words.push_back(slices.wires_[slot]);
+        if (not slices.nodes_.empty())
+            absorb(checkpoint_keys_->node_key(slices.nodes_[slot]));
+        if (not slices.leaksets_.empty() and slices.leaksets_[slot] != nullptr) {
+            words.push_back(slices.leaksets_[slot]->leaks.size());
+            for (const auto& bit_leak : slices.leaksets_[slot]->leaks.vector())
+                absorb(checkpoint_keys_->set_key(bit_leak.nodes()));
+        }
     }
-    return (vwog_leaking.size() + vwg_leaking.size() == 0);
+    return fingerprint(words).high_;
 }
 
 bool Manager::verify_higher_order_temporal() {
@@ -701,11 +1262,12 @@ bool Manager::verify_higher_order_temporal() {
     // We do not consider the first cycle (it is not really higher order anyways)
     // And it is an issue for our combination computation (we cannot generate a combination on a
     // vector of size 0)
-    if (this->measure_cycle() == 0)
+    if (this->history_ho_.size() <= 1)
         return true;
 
     // No output counting, this is not defined for SNI
-    unsigned int n = this->measure_cycle();
+    // Past cycles still in the window, the current one is the last of the history
+    unsigned int n = this->history_ho_.size() - 1;
     unsigned int r = (config_.ORDER_VERIF_ > n) ? n : config_.ORDER_VERIF_ - 1; // If order is bigger than our number of cycles, make a single combination of the current size
     std::vector<bool> v(n);
     std::fill(v.end() - r, v.end(), true);
@@ -719,14 +1281,15 @@ bool Manager::verify_higher_order_temporal() {
 
         // Loop through all wires, note that the entry for database[0] is used (this is the n that is
         // always involed in verification)
-        for (const auto& [name, entry] : database_[0]) {
+        for (WireId wire = 0; wire < database_[0].size(); ++wire) {
+            const Entry& entry = database_[0][wire];
             if (config_.VERIF_VALUE_WO_GLITCHES_) {
                 if (config_.BIT_VERIF_) {
                     for (int bit = 0; bit < entry.expr_->width; ++bit) {
                         std::vector<Node*> accumulate_verif_nodes{entry.expr_};
                         for (unsigned int i = 0; i < n; ++i) {
                             if (v[i]) {
-                                accumulate_verif_nodes.push_back(&simplify(Extract(bit, bit, *this->database_ho_.at(i).at(name).expr_)));
+                                accumulate_verif_nodes.push_back(this->history_ho_[i].bits_.nodes_[this->history_ho_[i].bits_.offsets_[wire] + bit]);
                             }
                         }
 
@@ -743,7 +1306,7 @@ bool Manager::verify_higher_order_temporal() {
                     std::vector<Node*> accumulate_verif_nodes{entry.expr_};
                     for (unsigned int i = 0; i < n; ++i) {
                         if (v[i]) {
-                            accumulate_verif_nodes.push_back(this->database_ho_.at(i).at(name).expr_);
+                            accumulate_verif_nodes.push_back(this->history_ho_[i].words_.nodes_[wire]);
                         }
                     }
 
@@ -760,7 +1323,7 @@ bool Manager::verify_higher_order_temporal() {
                 std::vector<leaks::LeakSet*> accumulate_lss{entry.leakset_};
                 for (unsigned int i = 0; i < n; ++i) {
                     if (v[i]) {
-                        accumulate_lss.push_back(this->database_ho_.at(i).at(name).leakset_);
+                        accumulate_lss.push_back(this->history_ho_[i].words_.leaksets_[wire]);
                     }
                 }
                 leaks::LeakSet* to_verif = leaks::merge(accumulate_lss);
@@ -810,11 +1373,11 @@ void Manager::track_parents(std::map<std::string, bool>& cache, std::set<std::st
 //        std::cout << depth << ":Wire " << needle << " has no parents." << std::endl;
 
     for (const auto& wire : parents) {
-        if (not database_[0].contains(wire)) {
+        if (not this->is_in_database(wire)) {
             std::cerr << "Wire not in db" << std::endl;
             std::abort();
         }
-        if (wire.starts_with("mem_") or database_[0].at(wire).type_ == Entry::WIRE) {
+        if (wire.starts_with("mem_") or this->database_entry(0, wire).type_ == Entry::WIRE) {
             //std::cout << depth << ": Parent is synchronous, ignoring" << std::endl;
             continue;
         }
@@ -824,10 +1387,12 @@ void Manager::track_parents(std::map<std::string, bool>& cache, std::set<std::st
             is_leaking = cache[wire];
         } else {
             //std::cout << depth << ":Parent is not in cache: " << wire << std::endl;
-            is_leaking |= (not is_leaking and config_.VERIF_TRANSITION_W_GLITCHES_ and not this->is_secure_twg(database_[0].at(wire), database_[1].at(wire)));
-            is_leaking |= (not is_leaking and config_.VERIF_VALUE_W_GLITCHES_ and not this->is_secure_vwg(database_[0].at(wire).leakset_, database_[0].at(wire).is_output_ ? 1 : 0));
-            is_leaking |= (not is_leaking and config_.VERIF_TRANSITION_WO_GLITCHES_ and not this->is_secure_twog(database_[0].at(wire), database_[1].at(wire)));
-            is_leaking |= (not is_leaking and config_.VERIF_VALUE_WO_GLITCHES_ and not this->is_secure_vwog(database_[0].at(wire).expr_, database_[0].at(wire).is_output_ ? 1 : 0));
+            const Entry& current = this->database_entry(0, wire);
+            const Entry& previous = this->database_entry(1, wire);
+            is_leaking |= (not is_leaking and config_.VERIF_TRANSITION_W_GLITCHES_ and not this->is_secure_twg(current, previous));
+            is_leaking |= (not is_leaking and config_.VERIF_VALUE_W_GLITCHES_ and not this->is_secure_vwg(current.leakset_, current.is_output_ ? 1 : 0));
+            is_leaking |= (not is_leaking and config_.VERIF_TRANSITION_WO_GLITCHES_ and not this->is_secure_twog(current, previous));
+            is_leaking |= (not is_leaking and config_.VERIF_VALUE_WO_GLITCHES_ and not this->is_secure_vwog(current.expr_, current.is_output_ ? 1 : 0));
 
             // If the parent is leaking and not in cache
             if (is_leaking) {
@@ -925,7 +1490,7 @@ void Manager::detail_leaks_vwog(const std::set<std::string>& wires) {
         leakage_file_ << "Wire: " << wire << " is leaking in Value without glitches at measure cycle: " << measure_cycle() << std::endl;
         detail_wire_info(wire);
         if (config_.DETAIL_SHOW_EXPRESSION_) {
-            leakage_file_ << "Its current expression is: " << database_[0][wire].expr_->verbatimPrint() << std::endl;
+            leakage_file_ << "Its current expression is: " << this->database_entry(0, wire).expr_->verbatimPrint() << std::endl;
         }
         leakage_file_ << "----------------------------" << std::endl;
     }
@@ -936,8 +1501,8 @@ void Manager::detail_leaks_twog(const std::set<std::string>& wires) {
         leakage_file_ << "Wire: " << wire << " is leaking in Transition without glitches at measure cycle: " << measure_cycle() << std::endl;
         detail_wire_info(wire);
         if (config_.DETAIL_SHOW_EXPRESSION_) {
-            leakage_file_ << "Its current expression is: " << database_[0][wire].expr_->verbatimPrint() << std::endl;
-            leakage_file_ << "Its previous expression is: " << database_[1][wire].expr_->verbatimPrint() << std::endl;
+            leakage_file_ << "Its current expression is: " << this->database_entry(0, wire).expr_->verbatimPrint() << std::endl;
+            leakage_file_ << "Its previous expression is: " << this->database_entry(1, wire).expr_->verbatimPrint() << std::endl;
         }
         leakage_file_ << "----------------------------" << std::endl;
     }
@@ -949,7 +1514,7 @@ void Manager::detail_leaks_vwg(const std::set<std::string>& wires) {
         leakage_file_ << "Wire: " << wire << " is leaking in Value with glitches at measure cycle: " << measure_cycle() << std::endl;
         if (config_.DETAIL_SHOW_EXPRESSION_) {
             leakage_file_ << "Its current leakset is: ";
-            leaks::print_leakage(database_[0][wire].leakset_, leakage_file_);
+            leaks::print_leakage(this->database_entry(0, wire).leakset_, leakage_file_);
             leakage_file_ << std::endl;
         }
         leakage_file_ << "----------------------------" << std::endl;
@@ -962,10 +1527,10 @@ void Manager::detail_leaks_twg(const std::set<std::string>& wires) {
         leakage_file_ << "Wire: " << wire << " is leaking in Transition with at measure cycle: " << measure_cycle() << std::endl;
         if (config_.DETAIL_SHOW_EXPRESSION_) {
             leakage_file_ << "Its current leakset is: ";
-            leaks::print_leakage(database_[0][wire].leakset_, leakage_file_);
+            leaks::print_leakage(this->database_entry(0, wire).leakset_, leakage_file_);
             leakage_file_ << std::endl;
             leakage_file_ << "Its previous leakset is: ";
-            leaks::print_leakage(database_[1][wire].leakset_, leakage_file_);
+            leaks::print_leakage(this->database_entry(1, wire).leakset_, leakage_file_);
             leakage_file_ << std::endl;
         }
         leakage_file_ << "----------------------------" << std::endl;
@@ -978,8 +1543,8 @@ void Manager::detail_leaks_all(const std::set<std::string>& wires) {
         leakage_file_ << "Wire: " << wire << " at measure cycle: " << measure_cycle() << std::endl;
         if (config_.DETAIL_SHOW_EXPRESSION_) {
             // TODO: This does not handle splitted wires
-            Entry& current = (database_[0].contains(wire)) ? database_[0][wire] : database_memory_[0][wire];
-            Entry& previous = (database_[1].contains(wire)) ? database_[1][wire] : database_memory_[1][wire];
+            Entry& current = this->database_entry(0, wire);
+            Entry& previous = this->database_entry(1, wire);
             leakage_file_ << "Its current expression is: " << current.expr_->verbatimPrint() << std::endl;
             if (config_.VERIF_VALUE_W_GLITCHES_ or config_.VERIF_TRANSITION_W_GLITCHES_) {
                 leakage_file_ << "Its current leakset is: ";
@@ -999,6 +1564,49 @@ void Manager::detail_leaks_all(const std::set<std::string>& wires) {
     }
 }
 
+bool Manager::is_secure(const Obligation& obligation) {
+    const Entry& curr = *obligation.curr_;
+    switch (obligation.kind_) {
+        case Obligation::VWOG:
+            return this->is_secure_vwog(curr.expr_, curr.is_output_ ? 1 : 0);
+        case Obligation::TWOG:
+            return this->is_secure_twog(curr, *obligation.prev_);
+        case Obligation::VWG:
+            return this->is_secure_vwg(curr.leakset_, curr.is_output_ ? 1 : 0);
+        case Obligation::TWG:
+            return this->is_secure_twg(curr, *obligation.prev_);
+    }
+    return true;
+}
+
+// Node verified for a transition, both nodes must be set and at least one must not be const
+Node* Manager::transition_node(Node* current_node, Node* previous_node) {
+    // If node is const, verify node before or the other way around if neither is const verify both
+    if (current_node->nature == CONST)
+        return previous_node;
+    else if (previous_node->nature == CONST)
+        return current_node;
+    return &simplify(*current_node ^ *previous_node);
+}
+
+// Sets verified for glitches, one per bit in bit verification, a single flattened one otherwise
+std::vector<std::set<Node*>> Manager::glitch_sets(leaks::LeakSet* current_leakset, leaks::LeakSet* previous_leakset) {
+    if (current_leakset == nullptr and previous_leakset == nullptr)
+        return {};
+
+    if (config_.BIT_VERIF_) {
+        if (previous_leakset == nullptr)
+            return current_leakset->sets();
+        if (current_leakset == nullptr)
+            return previous_leakset->sets();
+        return leaks::merge(current_leakset, previous_leakset)->sets();
+    }
+
+    std::set<Node*> set = leaks::flatten(current_leakset);
+    set.merge(leaks::flatten(previous_leakset));
+    return {set};
+}
+
 bool Manager::is_secure_vwog(Node* node, int outputs) {
     ++total_VWOG_;
 
@@ -1006,19 +1614,24 @@ bool Manager::is_secure_vwog(Node* node, int outputs) {
         cache_.incr_trivial_nodes();
         return true;
     }
-    if (Cache::CacheVerdict verdict = cache_.is_cached_node_secure(node); verdict.in_cache_)
+    // SNI verdicts depend on the number of shares allowed, thus on the outputs, NI ones on the
+    // order when several orders are verified
+    bool bounded = config_.SECURITY_PROPERTY_ == leaks::Properties::SNI or (config_.SECURITY_PROPERTY_ == leaks::Properties::NI and config_.ORDER_SWEEP_);
+    int bound = static_cast<int>(order_) - ((config_.SECURITY_PROPERTY_ == leaks::Properties::SNI) ? outputs : 0);
+    if (Cache::CacheVerdict verdict = (bounded) ? cache_.is_cached_node_secure(node, bound) : cache_.is_cached_node_secure(node); verdict.in_cache_)
         return verdict.is_secure_;
 
     ++verified_VWOG_;
 
     bool verification_verdict;
-    if (config_.BIT_VERIF_ and config_.ORDER_VERIF_ == 1)
-        verification_verdict = leaks::symb_verify_without_glitch_bit(node, config_.REMOVE_FALSE_NEGATIVE_, config_.SECURITY_PROPERTY_, config_.ORDER_VERIF_, outputs);
+    if (config_.BIT_VERIF_ and order_ == 1)
+        verification_verdict = leaks::symb_verify_without_glitch_bit(node, config_.REMOVE_FALSE_NEGATIVE_, config_.SECURITY_PROPERTY_, order_, outputs);
     else
-        verification_verdict = leaks::symb_verify_without_glitch(node, config_.REMOVE_FALSE_NEGATIVE_, config_.SECURITY_PROPERTY_, config_.ORDER_VERIF_, outputs);
+        verification_verdict = leaks::symb_verify_without_glitch(node, config_.REMOVE_FALSE_NEGATIVE_, config_.SECURITY_PROPERTY_, order_, outputs);
 
-    // No cache for SNI, it depends on the maxShareOcc would need another kind of cache
-    if (config_.SECURITY_PROPERTY_ != leaks::Properties::SNI)
+    if (bounded)
+        cache_.add_node_to_cache(node, bound, verification_verdict);
+    else
         cache_.add_node_to_cache(node, verification_verdict);
     return verification_verdict;
 }
@@ -1036,14 +1649,7 @@ bool Manager::is_secure_twog(const Entry& entry_curr, const Entry& entry_prev) {
         return true;
     }
 
-    // If node is const, verify node before or the other way around if neither is const verify both
-    Node* node;
-    if (current_node->nature == CONST)
-        node = previous_node;
-    else if (previous_node->nature == CONST)
-        node = current_node;
-    else
-        node = &simplify(*current_node ^ *previous_node);
+    Node* node = this->transition_node(current_node, previous_node);
 
     if (cache_.is_node_trivial(node)) {
         cache_.incr_trivial_nodes();
@@ -1057,16 +1663,16 @@ bool Manager::is_secure_twog(const Entry& entry_curr, const Entry& entry_prev) {
     // No output counting, transition is not defined for SNI
     bool verification_verdict;
     if (config_.BIT_VERIF_)
-        verification_verdict = leaks::symb_verify_without_glitch_bit(node, config_.REMOVE_FALSE_NEGATIVE_, config_.SECURITY_PROPERTY_, config_.ORDER_VERIF_, 0);
+        verification_verdict = leaks::symb_verify_without_glitch_bit(node, config_.REMOVE_FALSE_NEGATIVE_, config_.SECURITY_PROPERTY_, order_, 0);
     else
-        verification_verdict = leaks::symb_verify_without_glitch(node, config_.REMOVE_FALSE_NEGATIVE_, config_.SECURITY_PROPERTY_, config_.ORDER_VERIF_, 0);
+        verification_verdict = leaks::symb_verify_without_glitch(node, config_.REMOVE_FALSE_NEGATIVE_, config_.SECURITY_PROPERTY_, order_, 0);
 
     // No SNI with transitions, can always add to cache
     cache_.add_node_to_cache(node, verification_verdict);
     return verification_verdict;
 }
 
-bool Manager::is_secure_vwg(leaks::LeakSet* leakset, int outputs) {
+bool Manager::is_secure_vwg(leaks::LeakSet* leakset, int outputs, std::vector<std::pair<std::set<Node*>, bool>>* proven) {
     ++total_VWG_;
 
     if (leakset == nullptr) {
@@ -1074,13 +1680,30 @@ bool Manager::is_secure_vwg(leaks::LeakSet* leakset, int outputs) {
         return true;
     }
 
+    // SNI verdicts depend on the number of shares allowed, thus on the outputs, NI ones on the
+    // order when several orders are verified
+    bool bounded = config_.SECURITY_PROPERTY_ == leaks::Properties::SNI or (config_.SECURITY_PROPERTY_ == leaks::Properties::NI and config_.ORDER_SWEEP_);
+    int bound = static_cast<int>(order_) - ((config_.SECURITY_PROPERTY_ == leaks::Properties::SNI) ? outputs : 0);
+    auto cached = [&](const std::set<Node*>& set) {
+        return (bounded) ? cache_.is_cached_set_secure(set, bound) : cache_.is_cached_set_secure(set);
+    };
+    auto add_to_cache = [&](const std::set<Node*>& set, bool is_secure) {
+        if (proven != nullptr)
+            proven->push_back({set, is_secure});
+        if (bounded)
+            cache_.add_set_to_cache(set, bound, is_secure);
+        else
+            cache_.add_set_to_cache(set, is_secure);
+    };
+
     if (config_.BIT_VERIF_) {
-        for (auto& set : leakset->sets()) {
+        for (const leaks::BitLeaks& bit_leak : leakset->leaks) {
+            const std::set<Node*>& set = bit_leak.nodes();
             if (cache_.is_set_trivial(set)) {
                 cache_.incr_trivial_sets();
                 continue;
             }
-            if (Cache::CacheVerdict verdict = cache_.is_cached_set_secure(set); verdict.in_cache_) {
+            if (Cache::CacheVerdict verdict = cached(set); verdict.in_cache_) {
                 if (verdict.is_secure_)
                     continue;
                 return false;
@@ -1089,10 +1712,8 @@ bool Manager::is_secure_vwg(leaks::LeakSet* leakset, int outputs) {
             ++verified_VWG_;
 
             // If this bit is secure, continue to next bit. Otherwise stop there as non-secure
-            bool verification_verdict = leaks::symb_verify_with_glitch(set, config_.REMOVE_FALSE_NEGATIVE_, config_.SECURITY_PROPERTY_, config_.ORDER_VERIF_, outputs);
-            // No cache for SNI, it depends on the maxShareOcc would need another kind of cache
-            if (config_.SECURITY_PROPERTY_ != leaks::Properties::SNI)
-                cache_.add_set_to_cache(set, verification_verdict);
+            bool verification_verdict = leaks::symb_verify_with_glitch(set, config_.REMOVE_FALSE_NEGATIVE_, config_.SECURITY_PROPERTY_, order_, outputs);
+            add_to_cache(set, verification_verdict);
             if (verification_verdict)
                 continue;
             return false;
@@ -1105,14 +1726,13 @@ bool Manager::is_secure_vwg(leaks::LeakSet* leakset, int outputs) {
             cache_.incr_trivial_sets();
             return true;
         }
-        if (Cache::CacheVerdict verdict = cache_.is_cached_set_secure(set); verdict.in_cache_)
+        if (Cache::CacheVerdict verdict = cached(set); verdict.in_cache_)
             return verdict.is_secure_;
 
         ++verified_VWG_;
 
-        bool verification_verdict = leaks::symb_verify_with_glitch(set, config_.REMOVE_FALSE_NEGATIVE_, config_.SECURITY_PROPERTY_, config_.ORDER_VERIF_, outputs);
-        if (config_.SECURITY_PROPERTY_ != leaks::Properties::SNI)
-            cache_.add_set_to_cache(set, verification_verdict);
+        bool verification_verdict = leaks::symb_verify_with_glitch(set, config_.REMOVE_FALSE_NEGATIVE_, config_.SECURITY_PROPERTY_, order_, outputs);
+        add_to_cache(set, verification_verdict);
         return verification_verdict;
     }
 }
@@ -1138,7 +1758,8 @@ bool Manager::is_secure_twg(const Entry& entry_curr, const Entry& entry_prev) {
     // No output counting, transition is not defined for SNI
     if (config_.BIT_VERIF_) {
         leaks::LeakSet* leakset = leaks::merge(current_leakset, previous_leakset);
-        for (auto& set : leakset->sets()) {
+        for (const leaks::BitLeaks& bit_leak : leakset->leaks) {
+            const std::set<Node*>& set = bit_leak.nodes();
             if (cache_.is_set_trivial(set)) {
                 cache_.incr_trivial_sets();
                 continue;
@@ -1150,7 +1771,7 @@ bool Manager::is_secure_twg(const Entry& entry_curr, const Entry& entry_prev) {
             }
             ++verified_TWG_;
 
-            bool verification_verdict = leaks::symb_verify_with_glitch(set, config_.REMOVE_FALSE_NEGATIVE_, config_.SECURITY_PROPERTY_, config_.ORDER_VERIF_, 0);
+            bool verification_verdict = leaks::symb_verify_with_glitch(set, config_.REMOVE_FALSE_NEGATIVE_, config_.SECURITY_PROPERTY_, order_, 0);
             // No transitions with SNI so it's ok here
             cache_.add_set_to_cache(set, verification_verdict);
             if (verification_verdict)
@@ -1172,7 +1793,7 @@ bool Manager::is_secure_twg(const Entry& entry_curr, const Entry& entry_prev) {
             return verdict.is_secure_;
         ++verified_TWG_;
 
-        bool verification_verdict = leaks::symb_verify_with_glitch(set, config_.REMOVE_FALSE_NEGATIVE_, config_.SECURITY_PROPERTY_, config_.ORDER_VERIF_, 0);
+        bool verification_verdict = leaks::symb_verify_with_glitch(set, config_.REMOVE_FALSE_NEGATIVE_, config_.SECURITY_PROPERTY_, order_, 0);
         // No transitions with SNI so it's ok here
         cache_.add_set_to_cache(set, verification_verdict);
         return verification_verdict;
@@ -1194,6 +1815,9 @@ void Manager::end_measure() {
         std::cout << "Measure not started or already ended." << std::endl;
         return;
     }
+    // Measured cycles still verified in background belong to the measure
+    this->retire_verifications(0);
+    cache_.flush();
     measure_ended_ = true;
     end_cycle_ = steps_;
     end_measure_time_ = std::chrono::steady_clock::now();
@@ -1217,9 +1841,24 @@ void Manager::stat() {
     std::cout << "For this cycle:" << std::endl;
     std::cout << "Number of trivial sets verifications: " << cache_.get_trivial_sets() << std::endl;
     std::cout << "Number of setCacheHits : " << cache_.get_hits_sets() << std::endl;
+    std::cout << "Number of setCacheMisses : " << cache_.get_misses_sets() << std::endl;
     std::cout << "Number of trivial nodes verifications: " << cache_.get_trivial_nodes() << std::endl;
     std::cout << "Number of nodeCacheHits : " << cache_.get_hits_nodes() << std::endl;
+    if (cache_.subsumption() != nullptr)
+        std::cout << "Number of setSubsumptionHits : " << cache_.subsumption()->get_hits() << std::endl;
+    if (cache_.persistent() != nullptr)
+        std::cout << "Number of persistentCacheHits : " << cache_.persistent()->get_hits() << std::endl;
+    if (cache_.shared() != nullptr) {
+        std::cout << "Number of sharedCacheHits : " << cache_.shared()->get_hits() << std::endl;
+        std::cout << "Number of sharedCacheEvictions : " << cache_.shared()->get_evictions() << std::endl;
+    }
 
+    if (config_.ORDER_VERIF_ > 1 and config_.HIGHER_ORDER_TYPE_ == Configuration::SPATIAL) {
+        std::cout << "Number of pruned higher order tuples : " << pruned_tuples_ << std::endl;
+        std::cout << "Number of enumerated higher order tuples : " << enumerated_tuples_ << std::endl;
+        if (config_.ORDER_SWEEP_)
+            std::cout << "Number of tuples leaking through a lower order : " << inherited_leaks_ << std::endl;
+    }
     std::cout << "Number of leaks for each cycle: " << std::endl;
     for (auto const& [cycle, leaks] : leaks_per_cycles_) {
         if (leaks == 0) continue;
@@ -2,12 +2,18 @@
 #define TMPMANAGER_H
 
 #include <cstdint>
+#include <deque>
 #include <cxxrtl/cxxrtl.h>
 
 #include <sys/types.h>
 #include "configuration.h"
 
 #include "lss.h"
+#include "cache.h"
+#include "combinations.h"
+#include "wire_set.h"
+#include "wire_table.h"
+#include "workers.h"
 
 #include "utils.hpp"
 struct Entry {
@@ -23,63 +29,83 @@ struct Entry {
     leaks::LeakSet* leakset_;
 };
 
-// Simple helper class for cache that should be inlined
-class Cache {
-    private:
-        std::map<Node*, bool> verified_nodes_{};
-        std::map<std::set<Node*>, bool> verified_sets_{};
+// A verification to perform on a wire for the current cycle. The entries belong to the database,
+// an obligation is only valid until the database is rebuilt.
+struct Obligation {
+    enum Kind : uint8_t {
+        VWOG,
+        TWOG,
+        VWG,
+        TWG,
+    };
 
-        unsigned int cache_hit_node_ = 0;
-        unsigned int cache_hit_set_ = 0;
+    Kind kind_;
+    WireId wire_;
+    const Entry* curr_;
+    const Entry* prev_;
+};
 
-        unsigned int trivial_nodes_skipped_ = 0;
-        unsigned int trivial_sets_skipped_ = 0;
+// Proofs needed by the obligations of a cycle: deduplicated, neither trivial nor already in cache.
+// The kind of the first obligation requiring each proof is kept for statistics.
+struct ProofJobs {
+    std::vector<std::pair<Node*, Obligation::Kind>> nodes_{};
+    std::vector<std::pair<std::set<Node*>, Obligation::Kind>> sets_{};
 
+    size_t size() const { return nodes_.size() + sets_.size(); }
+};
+
+// Expressions and leaksets of a cycle cut per bit (or kept per word), flattened in a single table
+// built once per cycle so that higher order tuples are assembled by index. The slots of wire w
+// start at offsets_[w] until slots are reordered, only the requested columns are filled.
+struct Slices {
+    std::vector<uint32_t> offsets_{};
+    std::vector<WireId> wires_{};
+    std::vector<Node*> nodes_{};
+    std::vector<leaks::LeakSet*> leaksets_{};
+
+    size_t size() const { return wires_.size(); }
+};
+
+// Past cycles kept for higher order temporal verification, as slices holding only what the
+// verification needs: per word leaksets and nodes, per bit nodes in bit verification. With a
+// capacity, the most recent cycles only are kept in a ring buffer. Index 0 is the oldest cycle.
+class History {
     public:
-        struct CacheVerdict {
-            bool in_cache_ = false;
-            bool is_secure_ = true;
+        struct Cycle {
+            Slices words_{};
+            Slices bits_{};
         };
-        bool is_node_trivial(Node* node) const {
-            return (node->nature == CONST);
-        }
-        CacheVerdict is_cached_node_secure(Node* node) {
-            // If following is true, it is in cache
-            if (const auto& search = verified_nodes_.find(node); search != verified_nodes_.end()) {
-                ++cache_hit_node_;
-                return {true, search->second};
-            } else {
-                return {false, true};
-            }
-        }
 
-        bool is_set_trivial(const std::set<Node*>& set) const {
-            return (set.size() == 0);
-            // Maybe add later the if only containing const but check that it is pertinent
-        }
-        CacheVerdict is_cached_set_secure(const std::set<Node*>& set) {
-            // If following is true, it is in cache
-            if (const auto& search = verified_sets_.find(set); search != verified_sets_.end()) {
-                ++cache_hit_set_;
-                return {true, search->second};
+    private:
+        // 0 when unbounded
+        const size_t capacity_;
+        std::vector<Cycle> cycles_{};
+        size_t first_ = 0;
+
+    public:
+        explicit History(size_t capacity) : capacity_(capacity) {}
+
+        void push(Cycle&& cycle) {
+            if (capacity_ == 0 or cycles_.size() < capacity_) {
+                cycles_.push_back(std::move(cycle));
             } else {
-                return {false, true};
+                cycles_[first_] = std::move(cycle);
+                first_ = (first_ + 1) % capacity_;
             }
         }
+        const Cycle& operator[](size_t i) const { return cycles_[(first_ + i) % cycles_.size()]; }
+        size_t size() const { return cycles_.size(); }
+};
 
-        void incr_trivial_sets() { ++trivial_sets_skipped_; }
-        void incr_trivial_nodes() { ++trivial_nodes_skipped_; }
-        unsigned int get_trivial_sets() const { return trivial_sets_skipped_; }
-        unsigned int get_hits_sets() const { return cache_hit_set_; }
-        unsigned int get_trivial_nodes() const { return trivial_nodes_skipped_; }
-        unsigned int get_hits_nodes() const { return cache_hit_node_; }
-
-        void add_node_to_cache(Node* node, bool is_secure) {
-            verified_nodes_[node] = is_secure;
-        }
-        void add_set_to_cache(const std::set<Node*>& set, bool is_secure) {
-            verified_sets_[set] = is_secure;
-        }
+// A cycle whose proofs run in background while the following cycles are simulated. It owns a copy
+// of the databases of its cycle, the leaksets they refer to are kept until it is concluded.
+struct PendingCycle {
+    unsigned int step_;
+    std::array<std::vector<Entry>, 2> database_;
+    std::array<std::vector<std::pair<WireId, Entry>>, 2> database_memory_;
+    WireSet wires_elected_glitches_;
+    ProofJobs proofs_;
+    ProverPool::Batch batch_;
 };
 
 // The manager does not keep a reference to the top module as its type is not known at compilation
@@ -93,19 +119,58 @@ class Manager {
     private:
         cxxrtl::debug_items dbg_items_;
 
+        // Structures parsed from the circuit, by name
         std::map<std::string, std::set<std::string>> topology_;
         std::map<std::string, std::pair<std::set<std::string>, std::set<std::string>>> mux_structures_;
         std::set<std::string> split_wires_;
-        std::set<std::string> registers_and_outputs_;
-        std::set<std::string> inputs_of_stabilized_gate_;
 
-        // index 0 is always the most recent cycle
-        std::array<std::map<std::string, Entry>, 2> database_ = {};
-        std::array<std::map<std::string, Entry>, 2> database_memory_ = {};
-        // Only used for higher order
-        std::vector<std::map<std::string, Entry>> database_ho_ = {};
+        // Wires of the database have the lowest identifiers, given in name order. Other names
+        // (memories, wires only known from the topology) are interned after them.
+        WireTable wires_{};
 
-        Cache cache_{};
+        // A debug item visited when building the database, either a database wire or a memory
+        struct DebugWire {
+            WireId wire_;
+            const std::vector<cxxrtl::debug_item>* parts_;
+        };
+        // A signal split for word verification and the database wires of its parts
+        struct SplitException {
+            WireId signal_;
+            int width_;
+            const cxxrtl::debug_item* part_;
+            std::vector<WireId> parts_;
+        };
+        std::vector<DebugWire> debug_wires_;
+        std::vector<SplitException> split_exceptions_;
+        std::map<std::pair<WireId, size_t>, WireId> memory_cells_;
+
+        // Structures used at each cycle, by identifier. Fan-ins are kept as lists, a bitset per gate
+        // would be quadratic in the number of wires.
+        std::vector<std::vector<WireId>> gate_inputs_;
+        std::map<WireId, std::pair<std::vector<WireId>, std::vector<WireId>>> mux_inputs_;
+        std::set<WireId> registers_and_outputs_;
+        // Wires verified with glitches at every cycle: registers, outputs and split wires in word
+        // verification, or the whole database when forced
+        WireSet always_elected_;
+        WireSet inputs_of_stabilized_gate_;
+
+        // index 0 is always the most recent cycle, both are indexed by wire identifier
+        std::array<std::vector<Entry>, 2> database_ = {};
+        // Written memory cells only, in name order
+        std::array<std::vector<std::pair<WireId, Entry>>, 2> database_memory_ = {};
+        // Only used for higher order temporal, the current cycle is the last one
+        History history_ho_;
+
+        Cache cache_;
+        ProverPool prover_pool_;
+        // Oldest cycle first, only used when pipelining
+        std::deque<PendingCycle> pending_cycles_{};
+        // Higher order spatial chunks already proven by previous runs, when resuming, and the keys of
+        // the expressions they enumerate
+        std::unique_ptr<ChunkCheckpoint> checkpoint_{};
+        std::unique_ptr<StructuralKeys> checkpoint_keys_{};
+        // Order being verified, differs from the configured one during an order sweep only
+        size_t order_;
 
         unsigned int steps_ = 0;
 
@@ -120,6 +185,12 @@ class Manager {
         unsigned int verified_VWG_ = 0;
         unsigned int verified_TWG_ = 0;
 
+        // Higher order spatial tuples skipped because they depend on no secret, and those enumerated
+        uint64_t pruned_tuples_ = 0;
+        uint64_t enumerated_tuples_ = 0;
+        // Tuples of an order sweep leaking because they contain a leaking tuple of a lower order
+        uint64_t inherited_leaks_ = 0;
+
         unsigned int leaking_cycles_ = 0;
         std::map<unsigned int, unsigned int> leaks_per_cycles_{};
 
@@ -161,11 +232,35 @@ class Manager {
         void parse_circuit(std::ofstream& log);
 
         void init_database();
+        void index_circuit();
         void build_database();
+        WireId memory_cell(WireId memory, size_t index);
+
+        // Name based accesses, only meant for leak reports
+        bool is_in_database(const std::string& wire) const;
+        Entry& database_entry(size_t cycle, const std::string& wire);
 
+        WireSet elect_wires_glitches();
         bool verify();
+        bool conclude_verify(const std::vector<std::vector<Obligation>>& phases);
+        std::vector<std::vector<Obligation>> collect_obligations(const WireSet& wires_elected_glitches);
+        void prove_obligations(const std::vector<std::vector<Obligation>>& phases);
+        ProofJobs gather_proofs(const std::vector<std::vector<Obligation>>& phases);
+        bool prove(const ProofJobs& proofs, size_t index) const;
+        void store_proofs(const ProofJobs& proofs, const std::vector<bool>& verdicts);
+
+        void schedule_verify();
+        bool retire_verifications(size_t max_pending);
+        void cancel_verifications();
         bool verify_higher_order();
         bool verify_higher_order_spatial();
+        bool verify_spatial_order(const Slices& slices, size_t with_secret, std::set<std::vector<uint32_t>>* leaking_tuples);
+        bool verify_spatial_chunk(const Slices& slices, uint32_t r, uint64_t begin, uint64_t end, const SharedFlag& leak_found,
+            const std::set<std::vector<uint32_t>>* leaking_tuples, std::vector<uint32_t>& words, std::vector<uint32_t>* proofs);
+        void store_chunk_proofs(const Slices& slices, uint32_t r, const std::vector<uint32_t>& words, size_t begin);
+        Slices slice(const std::vector<Entry>& database, bool per_bit, bool nodes, bool leaksets) const;
+        size_t order_by_secret(Slices& slices, SupportTable& supports) const;
+        uint64_t slices_key(const Slices& slices, size_t with_secret);
         bool verify_higher_order_temporal();
 
         void track_parents(std::map<std::string, bool>& cache, std::set<std::string>& roots, const std::string& needle, int depth);
@@ -177,9 +272,13 @@ class Manager {
         void detail_leaks_twg(const std::set<std::string>& wires);
         void detail_leaks_all(const std::set<std::string>& wires);
 
+        Node* transition_node(Node* current_node, Node* previous_node);
+        std::vector<std::set<Node*>> glitch_sets(leaks::LeakSet* current_leakset, leaks::LeakSet* previous_leakset);
+
+        bool is_secure(const Obligation& obligation);
         bool is_secure_vwog(Node* expr, int outputs);
         bool is_secure_twog(const Entry& entry_curr, const Entry& entry_prev);
-        bool is_secure_vwg(leaks::LeakSet* ls, int outputs);
+        bool is_secure_vwg(leaks::LeakSet* ls, int outputs, std::vector<std::pair<std::set<Node*>, bool>>* proven = nullptr);
         bool is_secure_twg(const Entry& entry_curr, const Entry& entry_prev);
 };
 
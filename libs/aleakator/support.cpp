@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <utility>
+
+#include "support.h"
+
+size_t SupportTable::BitsHash::operator()(const std::vector<uint64_t>& bits) const {
+    uint64_t hash = 0x9e3779b97f4a7c15ULL;
+    for (uint64_t word : bits)
+        hash = (hash ^ word) * 0xff51afd7ed558ccdULL;
+    return hash ^ (hash >> 32);
+}
+
+// Identifier 0 is the empty support
+SupportTable::SupportTable() {
+    this->intern({});
+}
+
+uint32_t SupportTable::symbol(const Node* node) {
+    auto [it, inserted] = symbols_.try_emplace(node, static_cast<uint32_t>(symbols_.size()));
+    if (inserted and node->symbType == 'S') {
+        secrets_.resize(symbols_.size() / 64 + 1, 0);
+        secrets_[it->second / 64] |= uint64_t(1) << (it->second % 64);
+    }
+    return it->second;
+}
+
+// Trailing zero words are dropped so that equal supports have equal bits
+SupportId SupportTable::intern(std::vector<uint64_t>&& bits) {
+    while (not bits.empty() and bits.back() == 0)
+        bits.pop_back();
+
+    if (const auto& search = ids_.find(bits); search != ids_.end())
+        return search->second;
+
+    bool has_secret = false;
+    for (size_t i = 0; i < std::min(bits.size(), secrets_.size()); ++i)
+        has_secret |= (bits[i] & secrets_[i]) != 0;
+
+    SupportId id = static_cast<SupportId>(supports_.size());
+    ids_.emplace(bits, id);
+    supports_.push_back(std::move(bits));
+    has_secret_.push_back(has_secret);
+    return id;
+}
+
+// Expressions may be very deep, the traversal uses an explicit stack
+SupportId SupportTable::support(const Node* root) {
+    if (const auto& search = node_supports_.find(root); search != node_supports_.end())
+        return search->second;
+
+    std::vector<std::pair<const Node*, size_t>> stack{{root, 0}};
+    while (not stack.empty()) {
+        const Node* node = stack.back().first;
+        size_t next = stack.back().second;
+        if (next < node->children.size()) {
+            ++stack.back().second;
+            const Node* child = node->children[next];
+            if (not node_supports_.contains(child))
+                stack.push_back({child, 0});
+            continue;
+        }
+        stack.pop_back();
+        // Shared sub-expressions may have been pushed several times
+        if (node_supports_.contains(node))
+            continue;
+
+        std::vector<uint64_t> bits;
+        if (node->nature == SYMB) {
+            uint32_t symbol = this->symbol(node);
+            bits.resize(symbol / 64 + 1, 0);
+            bits[symbol / 64] |= uint64_t(1) << (symbol % 64);
+        }
+        for (const Node* child : node->children) {
+            const std::vector<uint64_t>& child_bits = supports_[node_supports_.at(child)];
+            bits.resize(std::max(bits.size(), child_bits.size()), 0);
+            for (size_t i = 0; i < child_bits.size(); ++i)
+                bits[i] |= child_bits[i];
+        }
+        node_supports_.emplace(node, this->intern(std::move(bits)));
+    }
+
+    return node_supports_.at(root);
+}
+
+SupportId SupportTable::unite(SupportId a, SupportId b) {
+    if (a == b or b == 0)
+        return a;
+    if (a == 0)
+        return b;
+
+    std::vector<uint64_t> bits = supports_[a];
+    const std::vector<uint64_t>& other = supports_[b];
+    bits.resize(std::max(bits.size(), other.size()), 0);
+    for (size_t i = 0; i < other.size(); ++i)
+        bits[i] |= other[i];
+    return this->intern(std::move(bits));
+}
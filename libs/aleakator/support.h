@@ -0,0 +1,48 @@
+#ifndef SUPPORT_H
+#define SUPPORT_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "verif_msi_pp.hpp"
+
+using SupportId = uint32_t;
+
+// Symbols an expression depends on, memoized per node. Nodes are hash-consed and never freed, their
+// addresses are stable keys. A support is a bitset over interned symbols, identical supports are
+// stored once and referred to by identifier, so that most nodes only cost a map entry.
+class SupportTable {
+    private:
+        struct BitsHash {
+            size_t operator()(const std::vector<uint64_t>& bits) const;
+        };
+
+        std::unordered_map<const Node*, uint32_t> symbols_{};
+        // Bits of the symbols of secret type
+        std::vector<uint64_t> secrets_{};
+
+        std::vector<std::vector<uint64_t>> supports_{};
+        std::vector<bool> has_secret_{};
+        std::unordered_map<std::vector<uint64_t>, SupportId, BitsHash> ids_{};
+        std::unordered_map<const Node*, SupportId> node_supports_{};
+
+        uint32_t symbol(const Node* node);
+        SupportId intern(std::vector<uint64_t>&& bits);
+
+    public:
+        SupportTable();
+
+        SupportId support(const Node* node);
+        SupportId unite(SupportId a, SupportId b);
+
+        const std::vector<uint64_t>& bits(SupportId id) const { return supports_[id]; }
+        bool has_secret(SupportId id) const { return has_secret_[id]; }
+        // An expression without secret cannot leak, whatever its masks and public data
+        bool has_secret(const Node* node) { return has_secret_[this->support(node)]; }
+
+        size_t symbols() const { return symbols_.size(); }
+        size_t size() const { return supports_.size(); }
+};
+
+#endif // SUPPORT_H
@@ -0,0 +1,68 @@
+#ifndef WIRE_SET_H
+#define WIRE_SET_H
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+#include "wire_table.h"
+
+// Set of wires stored as a bitset over wire identifiers. All the sets combined together must be
+// created with the same size, unions are then plain word-wide ORs. Iteration follows identifiers,
+// which is the name order for database wires.
+class WireSet {
+    private:
+        std::vector<uint64_t> words_{};
+
+    public:
+        WireSet() = default;
+        explicit WireSet(size_t size) : words_((size + 63) / 64, 0) {}
+
+        void insert(WireId wire) { words_[wire / 64] |= uint64_t(1) << (wire % 64); }
+        void erase(WireId wire) { words_[wire / 64] &= ~(uint64_t(1) << (wire % 64)); }
+        bool contains(WireId wire) const { return (words_[wire / 64] >> (wire % 64)) & 1; }
+
+        template<typename Iterator>
+        void insert(Iterator begin, Iterator end) {
+            for (; begin != end; ++begin)
+                this->insert(*begin);
+        }
+
+        // Insert all the wires whose identifier is below count
+        void insert_below(size_t count) {
+            std::fill(words_.begin(), words_.begin() + count / 64, ~uint64_t(0));
+            if (count % 64)
+                words_[count / 64] |= (uint64_t(1) << (count % 64)) - 1;
+        }
+
+        void clear() { std::fill(words_.begin(), words_.end(), 0); }
+
+        WireSet& operator|=(const WireSet& other) {
+            for (size_t i = 0; i < words_.size(); ++i)
+                words_[i] |= other.words_[i];
+            return *this;
+        }
+
+        size_t size() const {
+            size_t count = 0;
+            for (uint64_t word : words_)
+                count += std::popcount(word);
+            return count;
+        }
+
+        // Calls f on each wire of the set whose identifier is below limit, in identifier order
+        template<typename Function>
+        void for_each(size_t limit, Function&& f) const {
+            for (size_t i = 0; i < words_.size() and i * 64 < limit; ++i) {
+                for (uint64_t word = words_[i]; word != 0; word &= word - 1) {
+                    WireId wire = i * 64 + std::countr_zero(word);
+                    if (wire >= limit)
+                        return;
+                    f(wire);
+                }
+            }
+        }
+};
+
+#endif // WIRE_SET_H
@@ -0,0 +1,32 @@
+#ifndef WIRE_TABLE_H
+#define WIRE_TABLE_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using WireId = uint32_t;
+
+// Interns wire names into dense identifiers. Names are interned once, when the circuit is parsed,
+// afterwards they are only needed to report leaks.
+class WireTable {
+    private:
+        std::vector<std::string> names_{};
+        std::unordered_map<std::string, WireId> ids_{};
+
+    public:
+        WireId intern(const std::string& name) {
+            auto [it, inserted] = ids_.try_emplace(name, static_cast<WireId>(names_.size()));
+            if (inserted)
+                names_.push_back(name);
+            return it->second;
+        }
+
+        bool contains(const std::string& name) const { return ids_.contains(name); }
+        WireId id(const std::string& name) const { return ids_.at(name); }
+        const std::string& name(WireId id) const { return names_[id]; }
+        size_t size() const { return names_.size(); }
+};
+
+#endif // WIRE_TABLE_H
@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "workers.h"
+
+void write_all(int fd, const void* buffer, size_t size) {
+    const char* ptr = static_cast<const char*>(buffer);
+    while (size > 0) {
+        ssize_t written = ::write(fd, ptr, size);
+        if (written < 0 and errno == EINTR)
+            continue;
+        if (written <= 0)
+            throw std::runtime_error( "Could not write to worker pipe." );
+        ptr += written;
+        size -= written;
+    }
+}
+
+void read_all(int fd, void* buffer, size_t size) {
+    char* ptr = static_cast<char*>(buffer);
+    while (size > 0) {
+        ssize_t got = ::read(fd, ptr, size);
+        if (got < 0 and errno == EINTR)
+            continue;
+        if (got <= 0)
+            throw std::runtime_error( "Could not read from worker pipe, the worker probably crashed." );
+        ptr += got;
+        size -= got;
+    }
+}
+
+void write_string(int fd, const std::string& str) {
+    uint64_t size = str.size();
+    write_all(fd, &size, sizeof(size));
+    write_all(fd, str.data(), str.size());
+}
+
+std::string read_string(int fd) {
+    uint64_t size = 0;
+    read_all(fd, &size, sizeof(size));
+    std::string str(size, '\0');
+    read_all(fd, str.data(), size);
+    return str;
+}
+
+std::vector<bool> ProverPool::run(size_t count, const std::function<bool(size_t)>& prove) const {
+    // Not worth forking, prove everything in this process
+    if (workers_ <= 1 or count <= 1) {
+        std::vector<bool> verdicts(count, true);
+        for (size_t i = 0; i < count; ++i)
+            verdicts[i] = prove(i);
+        return verdicts;
+    }
+
+    Batch batch = this->launch(count, prove);
+    return this->collect(batch);
+}
+
+ProverPool::Batch ProverPool::spawn(size_t count, const std::function<void(size_t, size_t, int)>& work) const {
+    Batch batch{count, {}, {}};
+    if (count == 0)
+        return batch;
+
+    size_t workers = std::min(std::max<size_t>(workers_, 1), count);
+
+    // Anything buffered would be duplicated in children otherwise
+    std::cout.flush();
+
+    for (size_t k = 0; k < workers; ++k) {
+        int fd[2];
+        if (pipe(fd) != 0) {
+            this->cancel(batch);
+            throw std::runtime_error( "Could not create worker pipe." );
+        }
+
+        pid_t pid = fork();
+        if (pid < 0) {
+            close(fd[0]);
+            close(fd[1]);
+            this->cancel(batch);
+            throw std::runtime_error( "Could not fork verification worker." );
+        }
+
+        if (pid == 0) {
+            close(fd[0]);
+            int exit_status = EXIT_SUCCESS;
+            try {
+                work(k, workers, fd[1]);
+            } catch (...) {
+                exit_status = EXIT_FAILURE;
+            }
+            close(fd[1]);
+            // Do not run exit handlers nor flush inherited streams, the parent owns them
+            _exit(exit_status);
+        }
+
+        close(fd[1]);
+        batch.pids_.push_back(pid);
+        batch.fds_.push_back(fd[0]);
+    }
+
+    return batch;
+}
+
+bool ProverPool::wait(Batch& batch, bool failed) const {
+    for (size_t k = 0; k < batch.pids_.size(); ++k) {
+        close(batch.fds_[k]);
+        int status = 0;
+        waitpid(batch.pids_[k], &status, 0);
+        failed |= not WIFEXITED(status) or WEXITSTATUS(status) != EXIT_SUCCESS;
+    }
+    batch.pids_.clear();
+    batch.fds_.clear();
+    return not failed;
+}
+
+ProverPool::Batch ProverPool::launch(size_t count, const std::function<bool(size_t)>& prove) const {
+    return this->spawn(count, [&](size_t k, size_t workers, int fd) {
+        std::vector<char> results;
+        results.reserve(count / workers + 1);
+        for (size_t i = k; i < count; i += workers)
+            results.push_back(prove(i) ? 1 : 0);
+        write_all(fd, results.data(), results.size());
+    });
+}
+
+std::vector<bool> ProverPool::collect(Batch& batch) const {
+    std::vector<bool> verdicts(batch.count_, true);
+    size_t workers = batch.pids_.size();
+
+    bool failed = false;
+    for (size_t k = 0; k < workers; ++k) {
+        std::vector<char> results((batch.count_ - k + workers - 1) / workers);
+        try {
+            read_all(batch.fds_[k], results.data(), results.size());
+            for (size_t j = 0; j < results.size(); ++j)
+                verdicts[k + j * workers] = results[j];
+        } catch (const std::runtime_error&) {
+            failed = true;
+        }
+    }
+
+    if (not this->wait(batch, failed))
+        throw std::runtime_error( "A verification worker failed." );
+
+    return verdicts;
+}
+
+std::vector<std::string> ProverPool::map(size_t count, const std::function<std::string(size_t)>& work) const {
+    std::vector<std::string> results(count);
+    if (workers_ <= 1 or count <= 1) {
+        for (size_t i = 0; i < count; ++i)
+            results[i] = work(i);
+        return results;
+    }
+
+    Batch batch = this->spawn(count, [&](size_t k, size_t workers, int fd) {
+        for (size_t i = k; i < count; i += workers)
+            write_string(fd, work(i));
+    });
+
+    // Results are read in index order, each worker writes its own indexes in order
+    bool failed = false;
+    size_t workers = batch.pids_.size();
+    try {
+        for (size_t i = 0; i < count; ++i)
+            results[i] = read_string(batch.fds_[i % workers]);
+    } catch (const std::runtime_error&) {
+        failed = true;
+    }
+
+    if (not this->wait(batch, failed))
+        throw std::runtime_error( "A verification worker failed." );
+
+    return results;
+}
+
+void ProverPool::cancel(Batch& batch) const {
+    for (size_t k = 0; k < batch.pids_.size(); ++k) {
+        kill(batch.pids_[k], SIGKILL);
+        close(batch.fds_[k]);
+        waitpid(batch.pids_[k], nullptr, 0);
+    }
+    batch.pids_.clear();
+    batch.fds_.clear();
+}
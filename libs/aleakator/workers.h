@@ -0,0 +1,60 @@
+#ifndef WORKERS_H
+#define WORKERS_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+// verif_msi_pp hash-conses its nodes in process wide tables that are not synchronised, thus the
+// provers cannot be called from several threads. Parallelism is obtained with forked processes
+// instead: each worker inherits a copy-on-write snapshot of the simulation (nodes and leaksets
+// included) and only sends its verdicts back to the parent through a pipe.
+class ProverPool {
+    private:
+        const size_t workers_;
+
+    public:
+        // Proofs running in background workers, obtained from launch()
+        struct Batch {
+            size_t count_ = 0;
+            std::vector<pid_t> pids_{};
+            std::vector<int> fds_{};
+        };
+
+        explicit ProverPool(size_t workers) : workers_(workers) {}
+
+        size_t workers() const { return workers_; }
+
+        // Evaluates prove(i) for all i in [0, count) and returns verdicts in index order. Indexes
+        // are distributed round-robin so that neighbouring (and often similar) obligations are spread
+        // over the workers.
+        std::vector<bool> run(size_t count, const std::function<bool(size_t)>& prove) const;
+
+        // Same as run() but returns as soon as the workers are forked, even with a single worker, so
+        // that the caller can keep on simulating. Verdicts are obtained with collect().
+        Batch launch(size_t count, const std::function<bool(size_t)>& prove) const;
+        std::vector<bool> collect(Batch& batch) const;
+        // Kills the workers of the batch, their verdicts are lost
+        void cancel(Batch& batch) const;
+
+        // Same as run() for results that are more than a verdict
+        std::vector<std::string> map(size_t count, const std::function<std::string(size_t)>& work) const;
+
+    private:
+        // Forks the workers of a batch of count indexes, worker k runs work(k, workers, fd) where fd
+        // is the write end of its pipe
+        Batch spawn(size_t count, const std::function<void(size_t, size_t, int)>& work) const;
+        // Reaps the workers of the batch, returns false if one of them failed
+        bool wait(Batch& batch, bool failed) const;
+};
+
+// Small helpers to exchange raw buffers through pipes, they retry on partial operations and
+// throw on failure.
+void write_all(int fd, const void* buffer, size_t size);
+void read_all(int fd, void* buffer, size_t size);
+void write_string(int fd, const std::string& str);
+std::string read_string(int fd);
+
+#endif // WORKERS_H
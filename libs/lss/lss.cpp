@@ -1,3 +1,11 @@
+#include <algorithm>
+#include <bit>
+#include <unordered_map>
+#include <unordered_set>
+#if defined(LEAKSET_BITSET) and (defined(__AVX2__) or defined(__AVX512F__))
+#include <immintrin.h>
+#endif
+
 #include "lss.h"
 
 // If disabled, all functions will early return nullptr
@@ -9,44 +17,484 @@
 #endif
 
 namespace leaks {
-std::set<LeakSet*> LeakSet::ls_mem_ = std::set<LeakSet*>();
-std::set<LeakSet*> LeakSet::ls_keep_mem_ = std::set<LeakSet*>();
+#ifndef LEAKSET_BITSET
+struct BitLeaks::Storage {
+    std::set<Node*> nodes_;
+    size_t hash_ = 0;
+    size_t refs_ = 0;
+};
+#else
+// Leak atoms (the nodes of the sets) get dense identifiers in order of appearance. A bit is a
+// bitset over them stored from its first non zero word, atoms of a bit usually appear close in time.
+// A bit mixing atoms far apart is stored as the sorted list of their identifiers instead.
+struct BitLeaks::Storage {
+    uint32_t first_ = 0;
+    std::vector<uint64_t> words_{};
+    // Used instead of the words when they would be mostly zero, the other is then empty
+    std::vector<uint32_t> ids_{};
+    size_t hash_ = 0;
+    size_t refs_ = 0;
+    // Materialized on demand only, when iterated
+    std::unique_ptr<std::set<Node*>> nodes_ = nullptr;
+};
+#endif
+
+namespace {
+struct StorageHash {
+    size_t operator()(const BitLeaks::Storage* storage) const { return storage->hash_; }
+};
+struct StorageEqual {
+    bool operator()(const BitLeaks::Storage* a, const BitLeaks::Storage* b) const {
+#ifndef LEAKSET_BITSET
+        return a->hash_ == b->hash_ and a->nodes_ == b->nodes_;
+#else
+        return a->hash_ == b->hash_ and a->first_ == b->first_ and a->words_ == b->words_ and a->ids_ == b->ids_;
+#endif
+    }
+};
+using StoragePair = std::pair<const BitLeaks::Storage*, const BitLeaks::Storage*>;
+struct StoragePairHash {
+    size_t operator()(const StoragePair& pair) const {
+        return std::hash<const void*>()(pair.first) * 31 + std::hash<const void*>()(pair.second);
+    }
+};
+// The operands are held as well so that their storage is not reused while the entry exists
+struct Union {
+    BitLeaks first_;
+    BitLeaks second_;
+    BitLeaks result_;
+};
+
+// Never destroyed, bits may still be released while static objects are destroyed
+std::unordered_set<BitLeaks::Storage*, StorageHash, StorageEqual>& storages() {
+    static auto* storages = new std::unordered_set<BitLeaks::Storage*, StorageHash, StorageEqual>();
+    return *storages;
+}
+std::unordered_map<StoragePair, Union, StoragePairHash>& unions() {
+    static auto* unions = new std::unordered_map<StoragePair, Union, StoragePairHash>();
+    return *unions;
+}
+
+template<typename T>
+size_t hash_range(size_t hash, const T& range) {
+    for (const auto& elem : range)
+        hash ^= std::hash<std::remove_cvref_t<decltype(elem)>>()(elem) + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+// Returns the interned storage equal to the probe, the probe is moved in if there is none
+BitLeaks::Storage* intern(BitLeaks::Storage&& probe) {
+    auto it = storages().find(&probe);
+    if (it != storages().end())
+        return *it;
+    BitLeaks::Storage* storage = new BitLeaks::Storage(std::move(probe));
+    storages().insert(storage);
+    return storage;
+}
+
+#ifdef LEAKSET_BITSET
+std::vector<Node*>& atoms() {
+    static auto* atoms = new std::vector<Node*>();
+    return *atoms;
+}
+
+uint32_t atom(Node* node) {
+    static auto* ids = new std::unordered_map<Node*, uint32_t>();
+    auto [it, inserted] = ids->try_emplace(node, static_cast<uint32_t>(atoms().size()));
+    if (inserted)
+        atoms().push_back(node);
+    return it->second;
+}
+
+// dst |= src over count words
+void or_words(uint64_t* dst, const uint64_t* src, size_t count) {
+    size_t i = 0;
+#if defined(__AVX512F__)
+    for (; i + 8 <= count; i += 8) {
+        __m512i d = _mm512_loadu_si512(dst + i);
+        __m512i s = _mm512_loadu_si512(src + i);
+        _mm512_storeu_si512(dst + i, _mm512_or_si512(d, s));
+    }
+#elif defined(__AVX2__)
+    for (; i + 4 <= count; i += 4) {
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_or_si256(d, s));
+    }
+#endif
+    for (; i < count; ++i)
+        dst[i] |= src[i];
+}
+
+// A bit is stored sparse when its words would outnumber its atoms by this factor, the list of
+// identifiers is then at least four times smaller
+constexpr size_t SPARSE_WORDS_PER_ATOM = 2;
+
+size_t count_atoms(const BitLeaks::Storage& storage) {
+    size_t count = storage.ids_.size();
+    for (uint64_t word : storage.words_)
+        count += std::popcount(word);
+    return count;
+}
+
+template<typename F>
+void for_each_atom(const BitLeaks::Storage& storage, F&& f) {
+    for (uint32_t id : storage.ids_)
+        f(id);
+    for (size_t i = 0; i < storage.words_.size(); ++i)
+        for (uint64_t word = storage.words_[i]; word != 0; word &= word - 1)
+            f(static_cast<uint32_t>((storage.first_ + i) * 64 + std::countr_zero(word)));
+}
+
+// Storage of the sorted and unique identifiers, in the form that fits them, not interned yet
+BitLeaks::Storage from_atoms(std::vector<uint32_t>&& ids) {
+    BitLeaks::Storage result;
+    uint32_t first = ids.front() / 64, span = ids.back() / 64 - first + 1;
+    if (span > SPARSE_WORDS_PER_ATOM * ids.size()) {
+        result.ids_ = std::move(ids);
+        result.hash_ = hash_range(result.ids_.size(), result.ids_);
+        return result;
+    }
+    result.first_ = first;
+    result.words_.assign(span, 0);
+    for (uint32_t id : ids)
+        result.words_[id / 64 - first] |= uint64_t(1) << (id % 64);
+    result.hash_ = hash_range(result.first_, result.words_);
+    return result;
+}
+
+// Union of the storages, not interned yet. Dense storages are ORed in a bitset spanning all of
+// them unless the union is sure to be sparse, sparse ones are merged.
+BitLeaks::Storage unite_storages(const std::vector<const BitLeaks::Storage*>& storages) {
+    BitLeaks::Storage result;
+    if (storages.empty())
+        return result;
+
+    uint32_t first = UINT32_MAX, last = 0;
+    size_t atoms = 0;
+    for (const BitLeaks::Storage* storage : storages) {
+        if (storage->ids_.empty()) {
+            first = std::min(first, storage->first_);
+            last = std::max(last, static_cast<uint32_t>(storage->first_ + storage->words_.size()));
+        } else {
+            first = std::min(first, storage->ids_.front() / 64);
+            last = std::max(last, storage->ids_.back() / 64 + 1);
+        }
+        atoms += count_atoms(*storage);
+    }
+
+    if (last - first > SPARSE_WORDS_PER_ATOM * atoms) {
+        std::vector<uint32_t> ids;
+        ids.reserve(atoms);
+        for (const BitLeaks::Storage* storage : storages)
+            for_each_atom(*storage, [&](uint32_t id) { ids.push_back(id); });
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+        return from_atoms(std::move(ids));
+    }
+
+    result.first_ = first;
+    result.words_.assign(last - first, 0);
+    for (const BitLeaks::Storage* storage : storages) {
+        or_words(result.words_.data() + (storage->first_ - first), storage->words_.data(), storage->words_.size());
+        for (uint32_t id : storage->ids_)
+            result.words_[id / 64 - first] |= uint64_t(1) << (id % 64);
+    }
+    // Overlapping atoms may leave the union sparse
+    size_t count = count_atoms(result);
+    if (result.words_.size() > SPARSE_WORDS_PER_ATOM * count) {
+        std::vector<uint32_t> ids;
+        ids.reserve(count);
+        for_each_atom(result, [&](uint32_t id) { ids.push_back(id); });
+        return from_atoms(std::move(ids));
+    }
+    result.hash_ = hash_range(result.first_, result.words_);
+    return result;
+}
+#endif
+} // anonymous
+
+BitLeaks::BitLeaks(std::set<Node*>&& nodes) {
+    if (nodes.empty())
+        return;
+
+    Storage probe;
+#ifndef LEAKSET_BITSET
+    probe.nodes_ = std::move(nodes);
+    probe.hash_ = hash_range(probe.nodes_.size(), probe.nodes_);
+#else
+    std::vector<uint32_t> ids;
+    ids.reserve(nodes.size());
+    for (Node* node : nodes)
+        ids.push_back(atom(node));
+    std::sort(ids.begin(), ids.end());
+    probe = from_atoms(std::move(ids));
+#endif
+    storage_ = intern(std::move(probe));
+    ++storage_->refs_;
+}
+
+BitLeaks::BitLeaks(const BitLeaks& other) : storage_(other.storage_) {
+    if (storage_ != nullptr)
+        ++storage_->refs_;
+}
+
+void BitLeaks::release() {
+    if (storage_ == nullptr or --storage_->refs_ > 0)
+        return;
+    storages().erase(storage_);
+    delete storage_;
+    storage_ = nullptr;
+}
+
+const std::set<Node*>& BitLeaks::nodes() const {
+    static const std::set<Node*> empty;
+    if (storage_ == nullptr)
+        return empty;
+#ifndef LEAKSET_BITSET
+    return storage_->nodes_;
+#else
+    if (storage_->nodes_ == nullptr) {
+        storage_->nodes_ = std::make_unique<std::set<Node*>>();
+        for_each_atom(*storage_, [&](uint32_t id) { storage_->nodes_->insert(atoms()[id]); });
+    }
+    return *storage_->nodes_;
+#endif
+}
+
+size_t BitLeaks::size() const {
+    if (storage_ == nullptr)
+        return 0;
+#ifndef LEAKSET_BITSET
+    return storage_->nodes_.size();
+#else
+    return count_atoms(*storage_);
+#endif
+}
+
+void BitLeaks::insert(const BitLeaks& other) {
+    if (other.storage_ == nullptr or other.storage_ == storage_)
+        return;
+    if (storage_ == nullptr) {
+        *this = other;
+        return;
+    }
+
+    // Union is commutative, only one order is memoized
+    StoragePair key = (storage_ < other.storage_) ? StoragePair(storage_, other.storage_) : StoragePair(other.storage_, storage_);
+    auto it = unions().find(key);
+    if (it == unions().end()) {
+#ifndef LEAKSET_BITSET
+        std::set<Node*> nodes = storage_->nodes_;
+        nodes.insert(other.storage_->nodes_.begin(), other.storage_->nodes_.end());
+        BitLeaks result(std::move(nodes));
+#else
+        BitLeaks result;
+        result.storage_ = intern(unite_storages({storage_, other.storage_}));
+        ++result.storage_->refs_;
+#endif
+        it = unions().emplace(key, Union{*this, other, std::move(result)}).first;
+    }
+    *this = it->second.result_;
+}
+
+BitLeaks BitLeaks::unite(const std::vector<BitLeaks>& bits) {
+    BitLeaks result;
+#ifndef LEAKSET_BITSET
+    std::set<Node*> nodes;
+    for (const BitLeaks& bit : bits)
+        if (bit.storage_ != nullptr)
+            nodes.insert(bit.storage_->nodes_.begin(), bit.storage_->nodes_.end());
+    result = BitLeaks(std::move(nodes));
+#else
+    std::vector<const Storage*> storages;
+    for (const BitLeaks& bit : bits)
+        if (bit.storage_ != nullptr)
+            storages.push_back(bit.storage_);
+    if (storages.empty())
+        return result;
+    result.storage_ = intern(unite_storages(storages));
+    ++result.storage_->refs_;
+#endif
+    return result;
+}
+
+size_t BitLeaks::interned() {
+    return storages().size();
+}
+
+std::vector<LeakSet*> LeakSet::ls_mem_ = std::vector<LeakSet*>();
+// Starts at 1 so that a leakset that was never kept is not kept in the first epoch
+uint32_t LeakSet::epoch_ = 1;
+
+namespace {
+// Slot of the slab, free slots are linked through their own storage
+union Slot {
+    Slot* next_;
+    alignas(LeakSet) unsigned char storage_[sizeof(LeakSet)];
+};
+constexpr size_t SLOTS_PER_BLOCK = 4096;
+std::vector<std::unique_ptr<Slot[]>> blocks;
+Slot* free_slots = nullptr;
+ArenaStats stats;
+} // anonymous
+
+void* LeakSet::operator new(size_t size) {
+    // Derived types would not fit in a slot
+    if (size != sizeof(LeakSet))
+        return ::operator new(size);
+
+    if (free_slots == nullptr) {
+        blocks.push_back(std::make_unique<Slot[]>(SLOTS_PER_BLOCK));
+        Slot* block = blocks.back().get();
+        for (size_t i = 0; i + 1 < SLOTS_PER_BLOCK; ++i)
+            block[i].next_ = &block[i + 1];
+        block[SLOTS_PER_BLOCK - 1].next_ = nullptr;
+        free_slots = block;
+    }
+    Slot* slot = free_slots;
+    free_slots = slot->next_;
+    return slot;
+}
+
+void LeakSet::operator delete(void* ptr, size_t size) {
+    if (ptr == nullptr)
+        return;
+    if (size != sizeof(LeakSet)) {
+        ::operator delete(ptr);
+        return;
+    }
+    Slot* slot = static_cast<Slot*>(ptr);
+    slot->next_ = free_slots;
+    free_slots = slot;
+}
+
+// The storage of the bits is shared between leaksets, it is not accounted for
+size_t LeakSet::bytes() const {
+    return sizeof(LeakSet) + (leaks.pending() ? 0 : leaks.size() * sizeof(BitLeaks));
+}
+
+namespace {
+bool lazy = false;
+
+// Leakset of size bits computed by compute, right away or on first access in lazy mode. The
+// computation may only read the given operands, clear() keeps them as long as it is pending.
+LeakSet* defer(size_t size, std::vector<LeakSet*>&& operands, LeakBits::Compute&& compute) {
+    if (lazy) {
+        std::erase(operands, nullptr);
+        return new LeakSet(size, std::move(operands), std::move(compute));
+    }
+    LeakSet* ls = new LeakSet(size);
+    compute(ls->leaks.vector());
+    return ls;
+}
+
+// Leaksets only made of constants are dropped, unless they are not computed yet
+LeakSet* unless_unreal(LeakSet* ls) {
+    if (not lazy and not is_ls_real(ls))
+        return nullptr;
+    return ls;
+}
+struct Slices {
+    std::vector<Node*> bits_;
+    uint32_t used_;
+};
+
+std::unordered_map<Node*, Slices>& slices() {
+    static auto* slices = new std::unordered_map<Node*, Slices>();
+    return *slices;
+}
+} // anonymous
+
+Node* bit(Node* node, int i) {
+    auto [it, inserted] = slices().try_emplace(node);
+    Slices& node_slices = it->second;
+    node_slices.used_ = LeakSet::epoch_;
+    if (inserted)
+        node_slices.bits_.assign(node->width, nullptr);
+
+    Node*& slice = node_slices.bits_[i];
+    if (slice == nullptr)
+        slice = &simplify(Extract(i, i, *node));
+    return slice;
+}
+
+void share_bits(Node* to, size_t to_offset, Node* from, size_t from_offset, size_t count) {
+    if (to == from or count == 0)
+        return;
+    auto source = slices().find(from);
+    if (source == slices().end())
+        return;
+
+    // References to elements survive rehashing, iterators do not
+    const std::vector<Node*>& from_bits = source->second.bits_;
+    assert(from_offset + count <= from_bits.size());
+    auto range = std::ranges::subrange(from_bits.begin() + from_offset, from_bits.begin() + from_offset + count);
+    if (std::ranges::all_of(range, [](Node* slice) { return slice == nullptr; }))
+        return;
+    auto [it, inserted] = slices().try_emplace(to);
+    Slices& target = it->second;
+    target.used_ = LeakSet::epoch_;
+    if (inserted)
+        target.bits_.assign(to->width, nullptr);
+
+    assert(to_offset + count <= target.bits_.size() and from_offset + count <= from_bits.size());
+    for (size_t i = 0; i < count; ++i)
+        if (target.bits_[to_offset + i] == nullptr)
+            target.bits_[to_offset + i] = from_bits[from_offset + i];
+}
+
+size_t bit_slices() {
+    return slices().size();
+}
+
+void set_lazy(bool enable) {
+    lazy = enable;
+}
+
+bool is_lazy() {
+    return lazy;
+}
 
 // Allocates new leaksSet containing for each bit both given in arguments if they exist
 LeakSet* merge(LeakSet* first, LeakSet* second) {
     REMOVE_DISABLED
     if (first != nullptr and second != nullptr) {
         assert(first->leaks.size() == second->leaks.size());
-        return new LeakSet(*first, *second);
+        return defer(first->leaks.size(), {first, second}, [first, second](std::vector<BitLeaks>& bits) {
+            for (size_t i = 0; i < bits.size(); ++i) {
+                bits[i] = first->leaks[i];
+                bits[i].insert(second->leaks[i]);
+            }
+        });
     } else if (first == nullptr and second == nullptr) {
         return nullptr;
     } else {
-        // If first is not nullptr return it, otherwise return second, even if it is nullptr
-        return new LeakSet((first != nullptr) ? *first : *second);
+        // If first is not nullptr copy it, otherwise copy second
+        LeakSet* source = (first != nullptr) ? first : second;
+        return defer(source->leaks.size(), {source}, [source](std::vector<BitLeaks>& bits) {
+            bits = source->leaks.vector();
+        });
     }
 }
 
 // Allocates new leaksSet containing for each bit, all other in the vector
 LeakSet* merge(const std::vector<LeakSet*>& lss) {
     REMOVE_DISABLED
-    if (lss.size() == 0)
+    auto first = std::ranges::find_if(lss, [](LeakSet* ls) { return ls != nullptr; });
+    if (first == lss.end())
         return nullptr;
 
-    LeakSet* out = nullptr;
-    for (auto& ls : lss) {
-        // Find first ls and copy it
-        if (out == nullptr and ls != nullptr) {
-            out = new LeakSet(ls->leaks);
-        // Then populate with all other non null ls
-        } else if (ls != nullptr) {
-            assert(out->leaks.size() == ls->leaks.size());
-            for (size_t i = 0; i < ls->leaks.size(); ++i)
-                out->leaks[i].insert(ls->leaks[i].begin(), ls->leaks[i].end());
+    return defer((*first)->leaks.size(), std::vector<LeakSet*>(lss), [lss](std::vector<BitLeaks>& bits) {
+        // Null ls are skipped
+        for (auto& ls : lss) {
+            if (ls == nullptr)
+                continue;
+            assert(bits.size() == ls->leaks.size());
+            for (size_t i = 0; i < bits.size(); ++i)
+                bits[i].insert(ls->leaks[i]);
         }
-        // if ls is null continue
-    }
-
-    return out;
+    });
 }
 
 // Allocates new leaksSet containing all bits of all leaksets in entry if they exist
@@ -56,19 +504,18 @@ LeakSet* mix(LeakSet* first, LeakSet* second) {
     if (first != nullptr and second != nullptr)
         assert(first->leaks.size() == second->leaks.size());
 
-    int size = (first != nullptr) ? first->leaks.size() : second->leaks.size();
-    std::set<Node*> all_leaks;
-    if (first != nullptr)
-        for (size_t i = 0; i < first->leaks.size(); ++i)
-            all_leaks.insert(first->leaks[i].begin(), first->leaks[i].end());
+    size_t size = (first != nullptr) ? first->leaks.size() : second->leaks.size();
+    return defer(size, {first, second}, [first, second](std::vector<BitLeaks>& bits) {
+        BitLeaks all_leaks;
+        if (first != nullptr)
+            all_leaks = BitLeaks::unite(first->leaks.vector());
 
-    if (second != nullptr)
-        for (size_t i = 0; i < second->leaks.size(); ++i)
-            all_leaks.insert(second->leaks[i].begin(), second->leaks[i].end());
+        if (second != nullptr)
+            all_leaks.insert(BitLeaks::unite(second->leaks.vector()));
 
-    LeakSet* ls = new LeakSet(size);
-    std::fill(ls->leaks.begin(), ls->leaks.end(), all_leaks);
-    return ls;
+        // All bits share the same set
+        std::fill(bits.begin(), bits.end(), all_leaks);
+    });
 }
 
 LeakSet* extract(LeakSet* ls, size_t begin, size_t end) {
@@ -76,10 +523,11 @@ LeakSet* extract(LeakSet* ls, size_t begin, size_t end) {
     if (ls == nullptr) return nullptr;
     assert(begin <= end && begin >= 0 && end <= ls->leaks.size());
 
-    LeakSet* res = new LeakSet(std::vector<std::set<Node*>>(ls->leaks.cbegin() + begin, ls->leaks.cbegin() + end + 1));
+    LeakSet* res = defer(end - begin + 1, {ls}, [ls, begin](std::vector<BitLeaks>& bits) {
+        std::copy_n(ls->leaks.cbegin() + begin, bits.size(), bits.begin());
+    });
 
-    if (not is_ls_real(res)) return nullptr;
-    return res;
+    return unless_unreal(res);
 }
 
 LeakSet* sextend(LeakSet* ls, size_t new_size) {
@@ -88,14 +536,13 @@ LeakSet* sextend(LeakSet* ls, size_t new_size) {
     if (new_size == ls->leaks.size()) return ls;
     assert(new_size > 0 && new_size >= ls->leaks.size());
 
-    LeakSet* res = new LeakSet(new_size);
-    std::copy(ls->leaks.cbegin(), ls->leaks.cend(), res->leaks.begin());
+    return defer(new_size, {ls}, [ls](std::vector<BitLeaks>& bits) {
+        std::copy(ls->leaks.cbegin(), ls->leaks.cend(), bits.begin());
 
-    // Fill remaining created bits to MSB ls
-    for (size_t i = ls->leaks.size(); i < res->leaks.size(); ++i)
-        res->leaks[i].insert(ls->leaks[ls->leaks.size()-1].begin(), ls->leaks[ls->leaks.size()-1].end());
-
-    return res;
+        // Fill remaining created bits to MSB ls
+        for (size_t i = ls->leaks.size(); i < bits.size(); ++i)
+            bits[i] = ls->leaks[ls->leaks.size()-1];
+    });
 }
 
 LeakSet* extend(LeakSet* ls, size_t new_size) {
@@ -104,10 +551,9 @@ LeakSet* extend(LeakSet* ls, size_t new_size) {
     if (new_size == ls->leaks.size()) return ls;
     assert(new_size > 0 && new_size >= ls->leaks.size());
 
-    LeakSet* res = new LeakSet(new_size);
-    std::copy(ls->leaks.cbegin(), ls->leaks.cend(), res->leaks.begin());
-
-    return res;
+    return defer(new_size, {ls}, [ls](std::vector<BitLeaks>& bits) {
+        std::copy(ls->leaks.cbegin(), ls->leaks.cend(), bits.begin());
+    });
 }
 
 LeakSet* rextend(LeakSet* ls, size_t new_size) {
@@ -116,10 +562,9 @@ LeakSet* rextend(LeakSet* ls, size_t new_size) {
     if (new_size == ls->leaks.size()) return ls;
     assert(new_size > 0 && new_size >= ls->leaks.size());
 
-    LeakSet* res = new LeakSet(new_size);
-    std::copy(ls->leaks.cbegin(), ls->leaks.cend(), res->leaks.begin() + (new_size - ls->leaks.size()));
-
-    return res;
+    return defer(new_size, {ls}, [ls](std::vector<BitLeaks>& bits) {
+        std::copy(ls->leaks.cbegin(), ls->leaks.cend(), bits.begin() + (bits.size() - ls->leaks.size()));
+    });
 }
 
 LeakSet* blit(LeakSet* ls, LeakSet* source, size_t begin, size_t end, size_t size) {
@@ -130,13 +575,41 @@ LeakSet* blit(LeakSet* ls, LeakSet* source, size_t begin, size_t end, size_t siz
     assert(source == nullptr || (end-begin+1) == source->leaks.size());
     assert((source == nullptr || ls == nullptr) || source->leaks.size() < ls->leaks.size());
 
-    LeakSet* res = (ls != nullptr) ? new LeakSet(ls->leaks) : new LeakSet(size);
-    source = (source != nullptr) ? source : new LeakSet(end - begin + 1);
+    LeakSet* res = defer(size, {ls, source}, [ls, source, begin, end](std::vector<BitLeaks>& bits) {
+        if (ls != nullptr)
+            bits = ls->leaks.vector();
+        // Without source, the blitted bits are empty
+        if (source != nullptr)
+            std::ranges::copy_n(source->leaks.cbegin(), (end - begin + 1), bits.begin() + begin);
+        else
+            std::fill_n(bits.begin() + begin, (end - begin + 1), BitLeaks());
+    });
 
-    std::ranges::copy_n(source->leaks.cbegin(), (end - begin + 1), res->leaks.begin() + begin);
+    return unless_unreal(res);
+}
 
-    if (not is_ls_real(res)) return nullptr;
-    return res;
+LeakSet* concat(const std::vector<std::pair<LeakSet*, size_t>>& parts) {
+    REMOVE_DISABLED
+    size_t size = 0;
+    bool empty = true;
+    for (const auto& [ls, width] : parts) {
+        assert(ls == nullptr || width <= ls->leaks.size());
+        empty &= (ls == nullptr);
+        size += width;
+    }
+    if (empty) return nullptr;
+
+    std::vector<LeakSet*> operands;
+    for (const auto& part : parts)
+        operands.push_back(part.first);
+    return defer(size, std::move(operands), [parts](std::vector<BitLeaks>& bits) {
+        size_t position = 0;
+        for (const auto& [ls, width] : parts) {
+            if (ls != nullptr)
+                std::ranges::copy_n(ls->leaks.cbegin(), width, bits.begin() + position);
+            position += width;
+        }
+    });
 }
 
 LeakSet* replicate(LeakSet* source, size_t size) {
@@ -145,10 +618,9 @@ LeakSet* replicate(LeakSet* source, size_t size) {
     if (size == 1) return source;
     assert(size > 0 && source->leaks.size() == 1);
 
-    LeakSet* ls = new LeakSet(size);
-    std::fill(ls->leaks.begin(), ls->leaks.end(), source->leaks[0]);
-
-    return ls;
+    return defer(size, {source}, [source](std::vector<BitLeaks>& bits) {
+        std::fill(bits.begin(), bits.end(), source->leaks[0]);
+    });
 }
 
 LeakSet* reduce(LeakSet* source) {
@@ -156,11 +628,9 @@ LeakSet* reduce(LeakSet* source) {
     if (source == nullptr) return nullptr;
 
     // Create a 1bit leakset and fill it with every set of the vector
-    LeakSet* ls = new LeakSet(1);
-    for (size_t i = 0; i < source->leaks.size(); i++)
-        ls->leaks[0].insert(source->leaks[i].begin(), source->leaks[i].end());
-
-    return ls;
+    return defer(1, {source}, [source](std::vector<BitLeaks>& bits) {
+        bits[0] = BitLeaks::unite(source->leaks.vector());
+    });
 }
 
 LeakSet* reduce_and_merge(LeakSet* source1, LeakSet* source2) {
@@ -172,13 +642,10 @@ LeakSet* reduce_and_merge(LeakSet* source1, LeakSet* source2) {
     assert(source1->leaks.size() == source2->leaks.size());
 
     // Create a 1bit leakset and fill it with every set of the vector
-    LeakSet* ls = new LeakSet(1);
-    for (size_t i = 0; i < source1->leaks.size(); i++) {
-        ls->leaks[0].insert(source1->leaks[i].begin(), source1->leaks[i].end());
-        ls->leaks[0].insert(source2->leaks[i].begin(), source2->leaks[i].end());
-    }
-
-    return ls;
+    return defer(1, {source1, source2}, [source1, source2](std::vector<BitLeaks>& bits) {
+        bits[0] = BitLeaks::unite(source1->leaks.vector());
+        bits[0].insert(BitLeaks::unite(source2->leaks.vector()));
+    });
 }
 
 // TODO: i would like to test this loop
@@ -186,34 +653,34 @@ LeakSet* shift_left(LeakSet* source, LeakSet* amount_ls, size_t size) {
     REMOVE_DISABLED
     if (source == nullptr && amount_ls == nullptr) return nullptr;
 
-    std::set<Node*> amount_leak = flatten(amount_ls);
-    LeakSet* ls = new LeakSet(size);
-    for (size_t i = 0; i < size; ++i) {
-        if (source != nullptr)
-            amount_leak.insert(source->leaks.at(i).begin(), source->leaks.at(i).end());
+    return defer(size, {source, amount_ls}, [source, amount_ls](std::vector<BitLeaks>& bits) {
+        BitLeaks amount_leak(flatten(amount_ls));
+        for (size_t i = 0; i < bits.size(); ++i) {
+            if (source != nullptr)
+                amount_leak.insert(source->leaks.at(i));
 
-        // Leak all selector ls to each bit and if they exist, the cumulative
-        // Leaksets of the source up to the current bit
-        ls->leaks.at(i).insert(amount_leak.begin(), amount_leak.end());
-    }
-    return ls;
+            // Leak all selector ls to each bit and if they exist, the cumulative
+            // Leaksets of the source up to the current bit
+            bits.at(i) = amount_leak;
+        }
+    });
 }
 
 LeakSet* shift_right(LeakSet* source, LeakSet* amount_ls, size_t size) {
     REMOVE_DISABLED
     if (source == nullptr && amount_ls == nullptr) return nullptr;
 
-    std::set<Node*> amount_leak = flatten(amount_ls);
-    LeakSet* ls = new LeakSet(size);
-    for (int i = size - 1; i >= 0; --i) {
-        if (source != nullptr)
-            amount_leak.insert(source->leaks.at(i).begin(), source->leaks.at(i).end());
+    return defer(size, {source, amount_ls}, [source, amount_ls](std::vector<BitLeaks>& bits) {
+        BitLeaks amount_leak(flatten(amount_ls));
+        for (int i = bits.size() - 1; i >= 0; --i) {
+            if (source != nullptr)
+                amount_leak.insert(source->leaks.at(i));
 
-        // Leak all selector ls to each bit and if they exist, the cumulative
-        // Leaksets of the source upper bits down to the current bit
-        ls->leaks.at(i).insert(amount_leak.begin(), amount_leak.end());
-    }
-    return ls;
+            // Leak all selector ls to each bit and if they exist, the cumulative
+            // Leaksets of the source upper bits down to the current bit
+            bits.at(i) = amount_leak;
+        }
+    });
 }
 
 // We create a leakset of the size of the node and split each bit inside it
@@ -221,13 +688,38 @@ LeakSet* reg_stabilize(Node* node) {
     REMOVE_DISABLED
     if (node == nullptr or node->nature == CONST) return nullptr;
 
-    LeakSet* ls = new leaks::LeakSet(node->width);
-    for(int i = 0; i < node->width; ++i) {
-        Node* tbi = &simplify(Extract(i, i, *node));
-        if (tbi->nature != CONST) {
-            ls->leaks.at(i).insert(tbi);
+    return defer(node->width, {}, [node](std::vector<BitLeaks>& bits) {
+        for(int i = 0; i < node->width; ++i) {
+            Node* tbi = bit(node, i);
+            if (tbi->nature != CONST) {
+                bits.at(i).insert(tbi);
+            }
         }
-    }
+    });
+}
+
+LeakSet* reg_commit(Node* curr, Node* next) {
+    REMOVE_DISABLED
+    bool curr_leaks = curr != nullptr and curr->nature != CONST;
+    bool next_leaks = next != nullptr and next->nature != CONST;
+    if (not curr_leaks and not next_leaks) return nullptr;
+
+    int width = (next_leaks ? next : curr)->width;
+    LeakSet* ls = new LeakSet(width, {}, [curr, next, curr_leaks, next_leaks, width](std::vector<BitLeaks>& bits) {
+        for (int i = 0; i < width; ++i) {
+            if (curr_leaks) {
+                Node* tbi = bit(curr, i);
+                if (tbi->nature != CONST)
+                    bits.at(i).insert(tbi);
+            }
+            if (next_leaks) {
+                Node* tbi = bit(next, i);
+                if (tbi->nature != CONST)
+                    bits.at(i).insert(tbi);
+            }
+        }
+    });
+    ls->commit_ = true;
     return ls;
 }
 
@@ -238,23 +730,35 @@ LeakSet* partial_stabilize(LeakSet* ls_in, Node* node, uint32_t* stability) {
     //if (ls_in == nullptr or node == nullptr) return nullptr;
     //if (node == nullptr or node->nature == CONST) return nullptr;
 
-    bool empty_ls = true;
+    // The stability of the value changes afterwards, copy it for lazy computation
+    std::vector<uint32_t> stable(stability, stability + (node->width + 31) / 32);
+    if (ls_in == nullptr and std::ranges::all_of(stable, [](uint32_t chunk) { return chunk == 0; }))
+        return nullptr;
+    // The stable bits of a constant node leak nothing, the leakset is known to be empty without
+    // input or when all bits are stable. It is dropped before computing it, even in lazy mode.
+    if (node->nature == CONST) {
+        bool all_stable = true;
+        for (int i = 0; i < node->width; ++i)
+            all_stable &= (stable[i/32] >> (i%32)) & 1;
+        if (ls_in == nullptr or all_stable)
+            return nullptr;
+    }
+
     // Maybe we can initialize with a full copy then fix the stables, it may be faster
-    LeakSet* ls = new leaks::LeakSet(node->width);
-    for (int i = 0; i < node->width; ++i) {
-        if (stability[i/32] & (1 << (i%32))) {
-            Node* tbi = &simplify(Extract(i, i, *node));
-            if (tbi->nature != CONST) {
-                ls->leaks.at(i).insert(tbi);
-                empty_ls = false;
+    LeakSet* ls = defer(node->width, {ls_in}, [ls_in, node, stable = std::move(stable)](std::vector<BitLeaks>& bits) {
+        for (int i = 0; i < node->width; ++i) {
+            if (stable[i/32] & (1 << (i%32))) {
+                Node* tbi = bit(node, i);
+                if (tbi->nature != CONST) {
+                    bits.at(i).insert(tbi);
+                }
+            } else if (ls_in != nullptr) {
+                bits.at(i) = ls_in->leaks.at(i);
             }
-        } else if (ls_in != nullptr) {
-            ls->leaks.at(i) = ls_in->leaks.at(i);
-            empty_ls = false;
         }
-    }
-    if (empty_ls or not is_ls_real(ls)) return nullptr;
-    return ls;
+    });
+    // Without any leakage, is_ls_real drops it
+    return unless_unreal(ls);
 }
 
 // If lss are disabled, it should always be nullptr anyways
@@ -262,8 +766,13 @@ std::set<Node*> flatten(LeakSet* source) {
     std::set<Node*> res;
     if (source == nullptr) return res;
 
+#ifndef LEAKSET_BITSET
     for (size_t i = 0; i < source->leaks.size(); ++i)
         res.insert(source->leaks[i].begin(), source->leaks[i].end());
+#else
+    // A single OR pass then one materialization instead of a materialization per bit
+    res = BitLeaks::unite(source->leaks.vector()).nodes();
+#endif
 
     return res;
 }
@@ -271,7 +780,7 @@ std::set<Node*> flatten(LeakSet* source) {
 bool symb_verify_without_glitch_bit(Node* a, bool remove_false_negatives, Properties prop, int order, int outputs) {
     bool not_leaking = false;
     for (int i = 0; i < a->width; i++) {
-        Node& n = simplify(Extract(i, i, *a));
+        Node& n = *bit(a, i);
         switch (prop) {
             case Properties::TPS:
                 not_leaking = (remove_false_negatives) ? tpsNoFalsePositive(n, true) : tps(n, true);
@@ -364,23 +873,91 @@ bool is_ls_real(const LeakSet* ls) {
 }
 
 void clear() {
-    // Remove all ls that are in keepMem from Mem
-    for (auto& elem : LeakSet::ls_keep_mem_)
-        LeakSet::ls_mem_.erase(elem);
+    // Kept leaksets may still be computed from others that are about to be freed
+    std::vector<LeakSet*> lazily_kept;
+    for (LeakSet* ls : LeakSet::ls_mem_) {
+        if (ls->pins_ > 0)
+            ls->kept_ = LeakSet::epoch_;
+        if (ls->kept_ == LeakSet::epoch_ and not ls->leaks.operands().empty())
+            ls->leaks.vector();
+        else if (ls->lazily_kept_ == LeakSet::epoch_)
+            lazily_kept.push_back(ls);
+    }
+    // Those kept lazily keep the leaksets they are computed from instead, transitively
+    while (not lazily_kept.empty()) {
+        LeakSet* ls = lazily_kept.back();
+        lazily_kept.pop_back();
+        for (LeakSet* operand : ls->leaks.operands()) {
+            if (operand->kept_ != LeakSet::epoch_ and operand->lazily_kept_ != LeakSet::epoch_) {
+                operand->lazily_kept_ = LeakSet::epoch_;
+                lazily_kept.push_back(operand);
+            }
+        }
+    }
 
-    // Now delete all mem elems
-    // TODO: Carefull here, for outputs / inputs we may have elements deleted more than once !!!
-    for (auto ls : LeakSet::ls_mem_)
-        delete ls;
+    // Drop the unions memoized during the epoch, bits only used by them are freed with them
+    unions().clear();
+    if (slices().size() > BIT_SLICES_CAPACITY)
+        std::erase_if(slices(), [](const auto& entry) { return entry.second.used_ != LeakSet::epoch_; });
+
+    ArenaStats epoch_stats;
+    // Leaksets kept in this epoch are moved in front of the others which are all freed, those in
+    // front of the previous retained ones were allocated in this epoch
+    size_t retained = 0;
+    for (size_t i = 0; i < LeakSet::ls_mem_.size(); ++i) {
+        LeakSet* ls = LeakSet::ls_mem_[i];
+        size_t bytes = ls->bytes();
+        if (i >= stats.retained_) {
+            ++epoch_stats.allocated_;
+            epoch_stats.allocated_bytes_ += bytes;
+        }
+        if (ls->kept_ == LeakSet::epoch_ or ls->lazily_kept_ == LeakSet::epoch_) {
+            ++epoch_stats.retained_;
+            epoch_stats.retained_bytes_ += bytes;
+            LeakSet::ls_mem_[retained++] = ls;
+        } else {
+            epoch_stats.deferred_ += ls->leaks.pending();
+            if (ls->commit_) {
+                ++epoch_stats.commits_;
+                epoch_stats.unread_commits_ += ls->leaks.pending();
+            }
+            delete ls;
+        }
+    }
+    LeakSet::ls_mem_.resize(retained);
 
-    // Populate global mem with remaining ls then clear keep ls
-    LeakSet::ls_mem_ = LeakSet::ls_keep_mem_;
-    LeakSet::ls_keep_mem_.clear();
+    ++LeakSet::epoch_;
+    stats = epoch_stats;
 }
 
+// Keeping the same leakset several times is harmless, it is only tagged
 void keep(LeakSet* ls) {
     if (ls == nullptr) return;
-    LeakSet::ls_keep_mem_.insert(ls);
+    ls->kept_ = LeakSet::epoch_;
+}
+
+void pin(LeakSet* ls) {
+    if (ls == nullptr) return;
+    ++ls->pins_;
+}
+
+void unpin(LeakSet* ls) {
+    if (ls == nullptr) return;
+    assert(ls->pins_ > 0);
+    --ls->pins_;
+}
+
+void keep_lazy(LeakSet* ls) {
+    if (ls == nullptr) return;
+    if (not lazy) {
+        keep(ls);
+        return;
+    }
+    ls->lazily_kept_ = LeakSet::epoch_;
+}
+
+const ArenaStats& arena_stats() {
+    return stats;
 }
 
 } // leaks
@@ -2,8 +2,10 @@
 #define __LEAKS_H__
 
 #include <cassert>
+#include <functional>
 #include <memory>
 #include <set>
+#include <vector>
 #include "verif_msi_pp.hpp"
 #include "concrev.hpp"
 #include "SHA256.hpp"
@@ -16,36 +18,167 @@ namespace leaks {
 
 enum Properties { TPS, SNI, NI };
 
+// Leaking nodes of a single bit. Sets are hash-consed: equal sets share one immutable storage that
+// is reference counted, so copying and comparing bits only deal with pointers. Unions are memoized
+// on the pair of storages until the next clear(). An empty bit holds no storage.
+// The storage is either a std::set or, when lss is built with LEAKSET_BITSET, a bitset over dense
+// identifiers of the nodes whose unions are vectorized ORs, or the sorted list of the identifiers
+// when the bitset would be mostly zero.
+class BitLeaks {
+    public:
+        struct Storage;
+
+    private:
+        Storage* storage_ = nullptr;
+
+        void release();
+
+    public:
+        BitLeaks() = default;
+        BitLeaks(const std::set<Node*>& nodes) : BitLeaks(std::set<Node*>(nodes)) {}
+        BitLeaks(std::set<Node*>&& nodes);
+        BitLeaks(const BitLeaks& other);
+        BitLeaks(BitLeaks&& other) noexcept : storage_(other.storage_) { other.storage_ = nullptr; }
+        BitLeaks& operator=(BitLeaks other) noexcept {
+            std::swap(storage_, other.storage_);
+            return *this;
+        }
+        ~BitLeaks() { this->release(); }
+
+        const std::set<Node*>& nodes() const;
+        size_t size() const;
+        bool empty() const { return storage_ == nullptr; }
+        std::set<Node*>::const_iterator begin() const { return this->nodes().begin(); }
+        std::set<Node*>::const_iterator end() const { return this->nodes().end(); }
+
+        void insert(const BitLeaks& other);
+        void insert(Node* node) { this->insert(BitLeaks(std::set<Node*>{node})); }
+        // Union of all the bits, not memoized
+        static BitLeaks unite(const std::vector<BitLeaks>& bits);
+
+        bool operator==(const BitLeaks& other) const { return storage_ == other.storage_; }
+        bool operator==(const std::set<Node*>& nodes) const { return this->nodes() == nodes; }
+
+        // Number of distinct sets alive
+        static size_t interned();
+};
+
+struct LeakSet;
+
+// Bits of a leakset. In lazy mode, operations only record how to compute the bits of their
+// result from their operands, they are computed on first access. The number of bits is always
+// known.
+class LeakBits {
+    public:
+        using Compute = std::function<void(std::vector<BitLeaks>&)>;
+
+    private:
+        mutable std::vector<BitLeaks> bits_;
+        mutable Compute pending_{};
+        mutable std::vector<LeakSet*> operands_{};
+        size_t size_;
+
+        void materialize() const {
+            if (not pending_)
+                return;
+            Compute compute = std::move(pending_);
+            pending_ = nullptr;
+            bits_.resize(size_);
+            compute(bits_);
+            operands_.clear();
+        }
+
+    public:
+        explicit LeakBits(size_t size) : bits_(size), size_(size) {}
+        explicit LeakBits(const std::vector<BitLeaks>& bits) : bits_(bits), size_(bits.size()) {}
+        LeakBits(size_t size, std::vector<LeakSet*>&& operands, Compute&& compute)
+            : pending_(std::move(compute)), operands_(std::move(operands)), size_(size) {}
+
+        size_t size() const { return size_; }
+        bool pending() const { return static_cast<bool>(pending_); }
+        // Leaksets read by the pending computation
+        const std::vector<LeakSet*>& operands() const { return operands_; }
+
+        const std::vector<BitLeaks>& vector() const { this->materialize(); return bits_; }
+        std::vector<BitLeaks>& vector() { this->materialize(); return bits_; }
+        const BitLeaks& operator[](size_t i) const { return this->vector()[i]; }
+        BitLeaks& operator[](size_t i) { return this->vector()[i]; }
+        const BitLeaks& at(size_t i) const { return this->vector().at(i); }
+        BitLeaks& at(size_t i) { return this->vector().at(i); }
+        std::vector<BitLeaks>::const_iterator begin() const { return this->vector().cbegin(); }
+        std::vector<BitLeaks>::const_iterator end() const { return this->vector().cend(); }
+        std::vector<BitLeaks>::const_iterator cbegin() const { return this->vector().cbegin(); }
+        std::vector<BitLeaks>::const_iterator cend() const { return this->vector().cend(); }
+};
+
+// Leaksets allocated and retained by the last clear(), bytes do not include the shared bits.
+// Deferred leaksets were freed before their bits were ever needed.
+struct ArenaStats {
+    size_t allocated_ = 0;
+    size_t deferred_ = 0;
+    size_t allocated_bytes_ = 0;
+    size_t retained_ = 0;
+    size_t retained_bytes_ = 0;
+    // Leaksets of register commits freed, and those among them that were never read
+    size_t commits_ = 0;
+    size_t unread_commits_ = 0;
+};
+
+// Leaksets live until the end of the cycle (epoch) they were created in, unless keep() tags them
+// with the current epoch. clear() then frees all untagged leaksets at once and starts a new epoch.
+// Their storage comes from a slab of fixed size slots that is reused across epochs.
 struct LeakSet {
-    static std::set<LeakSet*> ls_mem_;
-    static std::set<LeakSet*> ls_keep_mem_;
-    std::vector<std::set<Node*>> leaks;
-    LeakSet(size_t size) : leaks(std::vector<std::set<Node*>>(size, std::set<Node*>())) {
-        LeakSet::ls_mem_.insert(this);
+    // Leaksets alive, those retained by the last clear() first then in allocation order
+    static std::vector<LeakSet*> ls_mem_;
+    static uint32_t epoch_;
+    // Last epoch in which the leakset was kept, and kept without being computed
+    uint32_t kept_ = 0;
+    uint32_t lazily_kept_ = 0;
+    // Number of pin() not undone by unpin()
+    uint32_t pins_ = 0;
+    // Created by reg_commit()
+    bool commit_ = false;
+    LeakBits leaks;
+    LeakSet(size_t size) : leaks(size) {
+        LeakSet::ls_mem_.push_back(this);
+    };
+    LeakSet(size_t size, std::vector<LeakSet*>&& operands, LeakBits::Compute&& compute) : leaks(size, std::move(operands), std::move(compute)) {
+        LeakSet::ls_mem_.push_back(this);
     };
-    LeakSet(const std::vector<std::set<Node*>>& leaks) : leaks(leaks) {
+    LeakSet(const std::vector<BitLeaks>& leaks) : leaks(leaks) {
 
 //        for (size_t i = 0; i < leaks.size(); ++i) {
 //            std::vector<Node*> leakages(leaks[i].begin(), leaks[i].end());
 //            assert(leakages.size() == 0 || tps(leakages, true));
 //        }
-        LeakSet::ls_mem_.insert(this);
+        LeakSet::ls_mem_.push_back(this);
     };
-    LeakSet(const LeakSet& first, const LeakSet& second) : leaks(first.leaks) {
+    LeakSet(const LeakSet& first, const LeakSet& second) : leaks(first.leaks.vector()) {
         assert(first.leaks.size() == second.leaks.size());
 
         for (size_t i = 0; i < second.leaks.size(); ++i)
-            leaks[i].insert(second.leaks[i].begin(), second.leaks[i].end());
+            leaks[i].insert(second.leaks[i]);
 
 //        for (size_t i = 0; i < second.leaks.size(); ++i) {
 //            std::vector<Node*> leakages(leaks[i].begin(), leaks[i].end());
 //            assert(leakages.size() == 0 || tps(leakages, true));
 //        }
-        LeakSet::ls_mem_.insert(this);
+        LeakSet::ls_mem_.push_back(this);
     };
+    // Copies would not be registered for clear()
+    LeakSet(const LeakSet&) = delete;
+    LeakSet& operator=(const LeakSet&) = delete;
     std::vector<std::set<Node*>> sets() {
-        return leaks;
+        std::vector<std::set<Node*>> sets;
+        sets.reserve(leaks.size());
+        for (const auto& bit_leak : leaks)
+            sets.push_back(bit_leak.nodes());
+        return sets;
     }
+    size_t bytes() const;
+
+    static void* operator new(size_t size);
+    static void operator delete(void* ptr, size_t size);
 
     friend auto operator<<(std::ostream& os, LeakSet const& m) -> std::ostream& {
         os << std::endl << "Leakages :" << std::endl;
@@ -71,6 +204,8 @@ LeakSet* sextend(LeakSet* ls, size_t new_size);
 LeakSet* extend(LeakSet* ls, size_t new_size);
 LeakSet* rextend(LeakSet* ls, size_t new_size);
 LeakSet* blit(LeakSet* ls, LeakSet* source, size_t begin, size_t end, size_t size);
+// Concatenation of the given number of low bits of each part, the first part is the LSB
+LeakSet* concat(const std::vector<std::pair<LeakSet*, size_t>>& parts);
 LeakSet* replicate(LeakSet* source, size_t size);
 
 LeakSet* reduce(LeakSet* source);
@@ -79,7 +214,20 @@ LeakSet* reduce_and_merge(LeakSet* source1, LeakSet* source2);
 LeakSet* shift_left(LeakSet* source, LeakSet* amount_ls, size_t size);
 LeakSet* shift_right(LeakSet* source, LeakSet* amount_ls, size_t size);
 
+// Simplified single bit slices of nodes, shared by lss and cxxrtl. They are memoized per node
+// and the nodes that were not used during an epoch are evicted by clear() once there are more than
+// BIT_SLICES_CAPACITY of them. Like the nodes, the table is not synchronised.
+constexpr size_t BIT_SLICES_CAPACITY = 1 << 18;
+Node* bit(Node* node, int i);
+// Records that count bits of to from to_offset are the bits of from from from_offset, for the
+// slices of from already known. Used by the operations that only move bits around.
+void share_bits(Node* to, size_t to_offset, Node* from, size_t from_offset, size_t count);
+size_t bit_slices();
+
 LeakSet* reg_stabilize(Node* node);
+// Same as merge(reg_stabilize(curr), reg_stabilize(next)) for a register going from curr to next.
+// It only reads the nodes, thus it is always computed on first access, even outside of lazy mode.
+LeakSet* reg_commit(Node* curr, Node* next);
 LeakSet* partial_stabilize(LeakSet* ls_in, Node* node, uint32_t* stability);
 std::set<Node*> flatten(LeakSet* source);
 
@@ -90,6 +238,17 @@ std::ostream& print_leakage(const LeakSet* ls, std::ostream& out = std::cout);
 bool is_ls_real(const LeakSet* ls);
 void clear();
 void keep(LeakSet* ls);
+// Same as keep() in lazy mode, except that the leakset is not computed at clear(): the leaksets it
+// is computed from are kept instead. Kept leaksets computed from nodes only are not computed either.
+void keep_lazy(LeakSet* ls);
+// Pinned leaksets are kept by every clear() until they are unpinned as many times as they were
+// pinned. State elements pin their leakset when it changes instead of keeping it on every cycle.
+void pin(LeakSet* ls);
+void unpin(LeakSet* ls);
+// Lazy mode defers the computation of leaksets bits until they are accessed
+void set_lazy(bool lazy);
+bool is_lazy();
+const ArenaStats& arena_stats();
 
 } // leaks
 
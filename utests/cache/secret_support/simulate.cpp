@@ -0,0 +1,37 @@
+#include <cassert>
+#include <set>
+#include "verif_msi_pp.hpp"
+#include "cache.h"
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) {
+    Node& a = symbol("a", 'S', 1);
+    Node& m0 = symbol("m0", 'M', 1);
+    Node& m1 = symbol("m1", 'M', 1);
+    Node& p = symbol("p", 'P', 1);
+
+    Node& masks = m0 ^ m1;
+    Node& public_data = masks & p;
+    Node& share = a ^ m0;
+
+    SupportTable supports;
+    assert(not supports.has_secret(&masks));
+    assert(not supports.has_secret(&public_data));
+    assert(supports.has_secret(&share));
+    assert(supports.has_secret(&(share ^ public_data)));
+
+    // Identical supports are shared
+    assert(supports.support(&masks) == supports.support(&(m1 ^ m0)));
+    assert(supports.unite(supports.support(&m0), supports.support(&m1)) == supports.support(&masks));
+    assert(supports.unite(supports.support(&masks), supports.support(&a)) == supports.support(&(share ^ m1)));
+
+    // Only expressions and sets with a secret are proven
+    Cache cache(false);
+    assert(not cache.is_node_trivial(&masks));
+    cache.use_secret_support();
+    assert(cache.is_node_trivial(&masks));
+    assert(not cache.is_node_trivial(&share));
+    assert(cache.is_set_trivial({&masks, &public_data}));
+    assert(not cache.is_set_trivial({&masks, &share}));
+
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include <cassert>
+#include <filesystem>
+#include <set>
+#include <vector>
+#include "verif_msi_pp.hpp"
+#include "cache.h"
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) {
+    std::vector<Node*> nodes;
+    for (int i = 0; i < 64; i++)
+        nodes.push_back(&symbol(("s" + std::to_string(i)).c_str(), 'S', 1));
+
+    for (bool exact : {false, true}) {
+        Cache cache(exact);
+
+        // Enough sets to force the table to grow several times
+        std::vector<std::set<Node*>> sets;
+        for (size_t i = 0; i < nodes.size(); i++)
+            for (size_t j = i + 1; j < nodes.size(); j++)
+                sets.push_back({nodes[i], nodes[j]});
+
+        for (size_t i = 0; i < sets.size(); i++) {
+            assert(not cache.contains_set(sets[i]));
+            cache.add_set_to_cache(sets[i], i % 3 != 0);
+        }
+
+        for (size_t i = 0; i < sets.size(); i++) {
+            Cache::CacheVerdict verdict = cache.is_cached_set_secure(sets[i]);
+            assert(verdict.in_cache_ && verdict.is_secure_ == (i % 3 != 0));
+        }
+        assert(cache.get_hits_sets() == sets.size());
+        assert(cache.get_misses_sets() == 0);
+
+        // Unknown set and overwritten verdict
+        std::set<Node*> unknown{nodes[0], nodes[1], nodes[2]};
+        assert(not cache.is_cached_set_secure(unknown).in_cache_);
+        assert(cache.get_misses_sets() == 1);
+        cache.add_set_to_cache(sets[0], true);
+        assert(cache.is_cached_set_secure(sets[0]).is_secure_);
+    }
+
+    // Bounded verdicts answer greater bounds when secure, smaller ones when leaking
+    {
+        Cache cache(true);
+        std::set<Node*> set{nodes[0], nodes[1]};
+        cache.add_set_to_cache(set, 2, true);
+        cache.add_set_to_cache(set, 0, false);
+        assert(cache.is_cached_set_secure(set, 3).is_secure_);
+        assert(not cache.is_cached_set_secure(set, 0).is_secure_);
+        assert(cache.is_cached_set_secure(set, -1).in_cache_);
+        assert(not cache.is_cached_set_secure(set, 1).in_cache_);
+        assert(not cache.is_cached_set_secure(set).in_cache_);
+
+        cache.add_node_to_cache(nodes[2], 1, false);
+        assert(not cache.is_cached_node_secure(nodes[2], 0).is_secure_);
+        assert(not cache.is_cached_node_secure(nodes[2], 2).in_cache_);
+    }
+
+    // Subsets of secure sets are secure, supersets of leaking sets are leaking
+    {
+        Cache cache(false);
+        cache.use_subsumption();
+        cache.add_set_to_cache({nodes[0], nodes[1], nodes[2]}, true);
+        cache.add_set_to_cache({nodes[3], nodes[4]}, false);
+
+        Cache::CacheVerdict verdict = cache.is_cached_set_secure({nodes[0], nodes[2]});
+        assert(verdict.in_cache_ and verdict.is_secure_);
+        verdict = cache.is_cached_set_secure({nodes[3], nodes[4], nodes[5]});
+        assert(verdict.in_cache_ and not verdict.is_secure_);
+        assert(not cache.is_cached_set_secure({nodes[0], nodes[5]}).in_cache_);
+        assert(not cache.is_cached_set_secure({nodes[3], nodes[1]}).in_cache_);
+        assert(cache.subsumption()->get_hits() == 2);
+        assert(cache.contains_set({nodes[1], nodes[2]}));
+        assert(cache.subsumption()->get_hits() == 2);
+    }
+
+    // Verdicts saved by a run are found again by the next one, with the same salt only
+    std::filesystem::path path = std::filesystem::temp_directory_path()/"set_verdicts.verdicts";
+    std::filesystem::remove(path);
+    std::set<Node*> pair{nodes[3], nodes[4]};
+    {
+        Cache cache(false);
+        cache.use_structural_keys(1);
+        cache.persist_to(path);
+        cache.add_node_to_cache(nodes[5], false);
+        cache.add_set_to_cache(pair, true);
+        cache.flush();
+    }
+    {
+        Cache cache(false);
+        cache.use_structural_keys(1);
+        cache.persist_to(path);
+        assert(cache.persistent()->get_loaded() == 2);
+        assert(cache.is_cached_set_secure(pair).is_secure_);
+        Cache::CacheVerdict verdict = cache.is_cached_node_secure(nodes[5]);
+        assert(verdict.in_cache_ and not verdict.is_secure_);
+        assert(cache.persistent()->get_hits() == 2);
+    }
+    // Loaded verdicts are indexed for subsumption
+    {
+        Cache cache(false);
+        cache.use_structural_keys(1);
+        cache.use_subsumption();
+        cache.persist_to(path);
+        assert(cache.is_cached_set_secure(pair).is_secure_);
+        Cache::CacheVerdict verdict = cache.is_cached_set_secure({nodes[3]});
+        assert(verdict.in_cache_ and verdict.is_secure_);
+        assert(cache.subsumption()->get_hits() == 1);
+    }
+    {
+        Cache cache(false);
+        cache.use_structural_keys(2);
+        cache.persist_to(path);
+        assert(not cache.is_cached_set_secure(pair).in_cache_);
+    }
+    std::filesystem::remove(path);
+
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include <cassert>
+#include <filesystem>
+#include <set>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "verif_msi_pp.hpp"
+#include "cache.h"
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) {
+    std::vector<Node*> nodes;
+    for (int i = 0; i < 16; i++)
+        nodes.push_back(&symbol(("s" + std::to_string(i)).c_str(), 'S', 1));
+
+    std::filesystem::path path = std::filesystem::temp_directory_path()/"shared_verdicts.table";
+    std::filesystem::remove(path);
+
+    // A verdict added by another process is seen without any synchronisation
+    std::set<Node*> pair{nodes[0], nodes[1]};
+    {
+        Cache cache(false);
+        cache.use_structural_keys(1);
+        cache.share_through(path, 64);
+        assert(not cache.contains_set(pair));
+
+        pid_t pid = fork();
+        if (pid == 0) {
+            Cache other(false);
+            other.use_structural_keys(1);
+            other.share_through(path, 1024);
+            other.add_set_to_cache(pair, false);
+            other.add_node_to_cache(nodes[2], true);
+            _exit(0);
+        }
+        int status = 0;
+        waitpid(pid, &status, 0);
+        assert(WIFEXITED(status) and WEXITSTATUS(status) == 0);
+
+        Cache::CacheVerdict verdict = cache.is_cached_set_secure(pair);
+        assert(verdict.in_cache_ and not verdict.is_secure_);
+        assert(cache.is_cached_node_secure(nodes[2]).is_secure_);
+        assert(cache.shared()->get_hits() == 2);
+        // The size of an existing table is kept
+        assert(cache.shared()->capacity() == 64);
+    }
+
+    // The table is bounded, filling it evicts older verdicts
+    {
+        Cache cache(false);
+        cache.use_structural_keys(2);
+        cache.share_through(path, 64);
+        for (size_t i = 0; i < nodes.size(); i++)
+            for (size_t j = i + 1; j < nodes.size(); j++)
+                cache.add_set_to_cache({nodes[i], nodes[j]}, true);
+        assert(cache.shared()->get_evictions() > 0);
+
+        // Other salts do not see the verdicts
+        Cache other(false);
+        other.use_structural_keys(3);
+        other.share_through(path, 64);
+        assert(not other.contains_set({nodes[0], nodes[1]}));
+    }
+    std::filesystem::remove(path);
+
+    return 0;
+}
@@ -0,0 +1,55 @@
+#include <cassert>
+#include <filesystem>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "combinations.h"
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) {
+    assert(combinations::binomial(5, 2) == 10);
+    assert(combinations::binomial(3, 5) == 0);
+    assert(combinations::binomial(60, 30) == 118264581564861424ULL);
+    assert(combinations::binomial(100, 50) == UINT64_MAX);
+
+    // Walking from any rank gives the same subsets as unranking each of them
+    for (uint32_t n = 1; n < 9; n++) {
+        for (uint32_t r = 1; r <= n; r++) {
+            std::vector<uint32_t> subset = combinations::unrank(0, n, r);
+            uint64_t count = combinations::binomial(n, r);
+            for (uint64_t rank = 0; rank < count; rank++) {
+                assert(combinations::unrank(rank, n, r) == subset);
+                assert(combinations::next(subset, n) == (rank + 1 < count));
+            }
+        }
+    }
+
+    // The flag set by a forked process is seen by its parent
+    SharedFlag flag;
+    pid_t pid = fork();
+    if (pid == 0) {
+        flag.set();
+        _exit(0);
+    }
+    waitpid(pid, nullptr, 0);
+    assert(flag.is_set());
+
+    // Recorded chunks are found again with the same salt and expressions only
+    std::filesystem::path path = std::filesystem::temp_directory_path()/"unrank.checkpoint";
+    std::filesystem::remove(path);
+    {
+        ChunkCheckpoint checkpoint(path, 1);
+        assert(checkpoint.size() == 0);
+        checkpoint.record(checkpoint.chunk(5, 3, 100, 2, 10, 7));
+    }
+    {
+        ChunkCheckpoint checkpoint(path, 1);
+        assert(checkpoint.size() == 1);
+        assert(checkpoint.is_done(checkpoint.chunk(5, 3, 100, 2, 10, 7)));
+        assert(not checkpoint.is_done(checkpoint.chunk(5, 3, 100, 2, 10, 8)));
+        assert(not checkpoint.is_done(checkpoint.chunk(6, 3, 100, 2, 10, 7)));
+        ChunkCheckpoint other(path, 2);
+        assert(not other.is_done(other.chunk(5, 3, 100, 2, 10, 7)));
+    }
+    std::filesystem::remove(path);
+
+    return 0;
+}
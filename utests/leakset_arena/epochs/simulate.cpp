@@ -0,0 +1,67 @@
+#include <iostream>
+#include "verif_msi_pp.hpp"
+#include "lss.h"
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) {
+    Node* a = &symbol("a", 'S', 4);
+    Node* b = &symbol("b", 'S', 4);
+    leaks::LeakSet* ls_a = leaks::reg_stabilize(a);
+    leaks::LeakSet* ls_b = leaks::reg_stabilize(b);
+    leaks::LeakSet* merged = leaks::merge(ls_a, ls_b);
+    assert(leaks::LeakSet::ls_mem_.size() == 3);
+
+    // Keeping twice the same leakset must not free it twice
+    leaks::keep(merged);
+    leaks::keep(merged);
+    leaks::keep(nullptr);
+    leaks::clear();
+    [[maybe_unused]] const leaks::ArenaStats& stats = leaks::arena_stats();
+    assert(stats.allocated_ == 3 && stats.retained_ == 1);
+    assert(stats.retained_bytes_ > 0 && stats.retained_bytes_ < stats.allocated_bytes_);
+    assert(leaks::LeakSet::ls_mem_.size() == 1 && leaks::LeakSet::ls_mem_[0] == merged);
+    for (int i = 0; i < a->width; i++) {
+        std::set<Node*> cmp{&simplify(Extract(i, i, *a)), &simplify(Extract(i, i, *b))};
+        assert(merged->leaks[i] == cmp);
+    }
+
+    // Slots of freed leaksets are reused, leaksets retained but not kept again are freed
+    leaks::LeakSet* mixed = leaks::mix(merged, nullptr);
+    assert(mixed != merged && mixed->leaks[0].size() == 8);
+    leaks::keep(mixed);
+    leaks::clear();
+    assert(stats.allocated_ == 1 && stats.retained_ == 1);
+    assert(leaks::LeakSet::ls_mem_.size() == 1 && leaks::LeakSet::ls_mem_[0] == mixed);
+
+    leaks::clear();
+    assert(stats.allocated_ == 0 && stats.retained_ == 0 && leaks::LeakSet::ls_mem_.empty());
+
+    // Register commits are only computed when read, even when kept
+    assert(leaks::reg_commit(&constant(0, 4), &constant(1, 4)) == nullptr);
+    leaks::LeakSet* unread = leaks::reg_commit(a, b);
+    leaks::LeakSet* committed = leaks::reg_commit(a, b);
+    assert(unread->leaks.pending() && committed->leaks.pending());
+    leaks::keep(committed);
+    leaks::clear();
+    assert(stats.commits_ == 1 && stats.unread_commits_ == 1);
+    assert(committed->leaks.pending());
+    for (int i = 0; i < a->width; i++) {
+        std::set<Node*> cmp{&simplify(Extract(i, i, *a)), &simplify(Extract(i, i, *b))};
+        assert(committed->leaks[i] == cmp);
+    }
+    leaks::clear();
+    assert(stats.commits_ == 1 && stats.unread_commits_ == 0);
+
+    // Pinned leaksets are retained until they are unpinned as many times
+    leaks::LeakSet* pinned = leaks::merge(leaks::reg_stabilize(a), leaks::reg_stabilize(b));
+    leaks::pin(pinned);
+    leaks::pin(pinned);
+    leaks::clear();
+    leaks::unpin(pinned);
+    leaks::clear();
+    assert(stats.retained_ == 1 && leaks::LeakSet::ls_mem_[0] == pinned);
+    assert(!pinned->leaks.pending() && pinned->leaks[0].size() == 2);
+    leaks::unpin(pinned);
+    leaks::clear();
+    assert(stats.retained_ == 0 && leaks::LeakSet::ls_mem_.empty());
+    verifMSICleanup();
+}
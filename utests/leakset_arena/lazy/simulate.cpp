@@ -0,0 +1,47 @@
+#include <iostream>
+#include "verif_msi_pp.hpp"
+#include "lss.h"
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) {
+    leaks::set_lazy(true);
+    Node* a = &symbol("a", 'S', 4);
+    Node* b = &symbol("b", 'S', 4);
+    leaks::LeakSet* ls_a = leaks::reg_stabilize(a);
+    leaks::LeakSet* ls_b = leaks::reg_stabilize(b);
+
+    // Nothing is computed until the bits are read, sizes are known beforehand
+    leaks::LeakSet* merged = leaks::merge(ls_a, ls_b);
+    leaks::LeakSet* mixed = leaks::mix(merged, nullptr);
+    [[maybe_unused]] leaks::LeakSet* unused = leaks::mix(ls_a, nullptr);
+    assert(merged->leaks.pending() && mixed->leaks.pending() && ls_a->leaks.pending());
+    assert(mixed->leaks.size() == 4);
+
+    // The stability is copied, later changes of the value are not seen
+    uint32_t stability[1] = {0b0001};
+    leaks::LeakSet* stabilized = leaks::partial_stabilize(ls_b, a, stability);
+    stability[0] = 0;
+    assert(leaks::partial_stabilize(nullptr, a, stability) == nullptr);
+
+    // Lazily kept leaksets keep their operands instead of being computed
+    leaks::keep_lazy(mixed);
+    leaks::keep(stabilized);
+    leaks::clear();
+    [[maybe_unused]] const leaks::ArenaStats& stats = leaks::arena_stats();
+    assert(stats.deferred_ == 1 && stats.retained_ == 5);
+    assert(mixed->leaks.pending() and not stabilized->leaks.pending());
+    assert(stabilized->leaks[0] == std::set<Node*>{&simplify(Extract(0, 0, *a))});
+    assert(stabilized->leaks[1] == std::set<Node*>{&simplify(Extract(1, 1, *b))});
+
+    // Computed on access, from operands of the previous epoch
+    assert(mixed->leaks[3].size() == 8 && mixed->leaks[0] == mixed->leaks[3]);
+    assert(merged->leaks[2] == (std::set<Node*>{&simplify(Extract(2, 2, *a)), &simplify(Extract(2, 2, *b))}));
+
+    // Once computed, the operands are released
+    leaks::keep_lazy(mixed);
+    leaks::clear();
+    assert(stats.retained_ == 1 && leaks::LeakSet::ls_mem_.size() == 1);
+    leaks::clear();
+
+    leaks::set_lazy(false);
+    verifMSICleanup();
+}
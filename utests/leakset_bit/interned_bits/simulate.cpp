@@ -0,0 +1,71 @@
+#include <iostream>
+#include "verif_msi_pp.hpp"
+#include "lss.h"
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) {
+    Node* a = &symbol("a", 'S', 4);
+    Node* b = &symbol("b", 'S', 4);
+    Node* a0 = &simplify(Extract(0, 0, *a));
+    Node* b0 = &simplify(Extract(0, 0, *b));
+
+    // Equal sets share their storage, the empty set has none
+    leaks::BitLeaks first(std::set<Node*>{a0, b0});
+    leaks::BitLeaks second(std::set<Node*>{b0, a0});
+    assert(first == second && first.size() == 2);
+    assert(leaks::BitLeaks().empty() && leaks::BitLeaks(std::set<Node*>{}).empty());
+    assert(leaks::BitLeaks::interned() == 1);
+
+    // Unions are sets unions whatever the order, and equal to the interned set
+    leaks::BitLeaks only_a(std::set<Node*>{a0});
+    leaks::BitLeaks only_b(std::set<Node*>{b0});
+    leaks::BitLeaks left = only_a;
+    left.insert(only_b);
+    leaks::BitLeaks right = only_b;
+    right.insert(only_a);
+    assert(left == first && right == first);
+    assert(left == (std::set<Node*>{a0, b0}));
+    // Inserting into a copy does not change the original
+    assert(only_a.size() == 1 && *only_a.begin() == a0);
+
+    // Sets of nodes that appeared far apart are equal whatever the order of their unions
+    std::vector<leaks::BitLeaks> spread;
+    for (int i = 0; i < 512; i++)
+        spread.emplace_back(std::set<Node*>{&symbol("s" + std::to_string(i), 'S', 1)});
+    Node* late = *spread.back().begin();
+    leaks::BitLeaks far = only_a;
+    far.insert(spread.back());
+    assert(far == (std::set<Node*>{a0, late}) && far.size() == 2);
+    assert(far == leaks::BitLeaks(std::set<Node*>{late, a0}));
+    leaks::BitLeaks all = leaks::BitLeaks::unite(spread);
+    assert(all.size() == 512 && all == leaks::BitLeaks::unite({all, spread[7], spread[300]}));
+    far.insert(all);
+    assert(far.size() == 513 && far.nodes().count(a0) == 1);
+
+    // All the bits of a mix share the same set
+    leaks::LeakSet* mixed = leaks::mix(leaks::reg_stabilize(a), leaks::reg_stabilize(b));
+    for (int i = 1; i < a->width; i++)
+        assert(mixed->leaks[i] == mixed->leaks[0]);
+    assert(mixed->leaks[0].size() == 8);
+
+    // Bits only referenced by freed leaksets and memoized unions are released at clear
+    [[maybe_unused]] size_t before = leaks::BitLeaks::interned();
+    leaks::keep(mixed);
+    leaks::clear();
+    assert(leaks::BitLeaks::interned() < before);
+    assert(mixed->leaks[3].size() == 8);
+    leaks::clear();
+
+    // Bit slices are memoized per node
+    [[maybe_unused]] size_t nodes = leaks::bit_slices();
+    for (int i = 0; i < a->width; i++)
+        assert(leaks::bit(a, i) == &simplify(Extract(i, i, *a)));
+    assert(leaks::bit(a, 2) == leaks::bit(a, 2));
+    assert(leaks::bit_slices() <= nodes + 1);
+
+    // Slices of a node made of the bits of another are those of the other
+    Node* low = &simplify(Extract(1, 0, *a));
+    leaks::share_bits(low, 0, a, 0, 2);
+    assert(leaks::bit(low, 1) == leaks::bit(a, 1) && leaks::bit(low, 0) == leaks::bit(a, 0));
+
+    verifMSICleanup();
+}
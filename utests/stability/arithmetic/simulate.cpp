@@ -24,7 +24,8 @@ std::bitset<64> stability(const cxxrtl::value<Bits>& val) {
     return ret;
 }
 
-int main(int argc, char *argv[]) {
+// Runs in eager and lazy leakset modes, constant operands must end without a leakset in both
+void check_arithmetic() {
     cxxrtl::value<50> a{0x1u, 0x0u};
     cxxrtl::value<50> b{0x1u, 0x0u};
     cxxrtl::value<50> c;
@@ -109,7 +110,7 @@ int main(int argc, char *argv[]) {
     std::cout << stability(a) << std::endl;
     std::cout << stability(b) << std::endl;
     std::cout << stability(c) << std::endl;
-    assert(stability(c) == 0x0000888888888888ull);
+    assert(stability(c) == 0x0000888888888888ull && c.ls == nullptr);
     std::cout << "Mux sel unstable bit c: " << stability(c) << std::endl;
 
     sel.stability[0] = 0x00000001ull;
@@ -123,5 +124,29 @@ int main(int argc, char *argv[]) {
     assert(stability(c) == 0x0002AAAAAAAAAAAAull);
     std::cout << "Mux sel stable partially stable selected bit c: " << stability(c) << std::endl;
 
+    // Equal stable inputs make a constant stable output whatever the leaking selector
+    cxxrtl::value<1> leaky{0x1u};
+    leaky.stability[0] = 0x0u;
+    leaky.ls = leaks::reg_stabilize(&symbol("sel", 'S', 1));
+    cxxrtl::value<50> d{0x5u, 0x0u};
+    c = cxxrtl_yosys::symb_mux(leaky, d, d);
+    assert(stability(c) == 0x0003FFFFFFFFFFFFull && c.is_concrete());
+    std::cout << "Mux sel leaking equal inputs c: " << stability(c) << std::endl;
+
+    // Fully concrete operands stay concrete, without any leakset
+    c = a.add(b).sub(a).neg();
+    assert(c.node->nature == CONST and c.ls == nullptr);
+    assert(c.node == a.add(b).sub(a).neg().node);
+    cxxrtl::value<1> flag = sel.bit_not().bit_xor(sel);
+    assert(flag.node->nature == CONST and flag.ls == nullptr and flag.data[0] == 0x1u);
+    std::cout << "Concrete operations stay concrete" << std::endl;
+}
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) {
+    check_arithmetic();
+    leaks::set_lazy(true);
+    check_arithmetic();
+    leaks::set_lazy(false);
+
     verifMSICleanup();
 }
@@ -0,0 +1,78 @@
+#include <iostream>
+#include "cxxrtl/cxxrtl.h"
+#include "verif_msi_pp.hpp"
+#include "lss.h"
+
+// Global to cxxrtl, must be defined but will produce no logs here
+std::ofstream simulation_logger;
+
+struct Observer {
+    void on_update(size_t, const cxxrtl::chunk_t*, const cxxrtl::chunk_t*) {}
+    void on_update(size_t, const cxxrtl::chunk_t*, const cxxrtl::chunk_t*, size_t) {}
+};
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) {
+    cxxrtl::op_memo::enable(4);
+    const cxxrtl::op_memo::stats& stats = cxxrtl::op_memo::statistics();
+
+    cxxrtl::value<8> a;
+    a.setNode(&symbol("a", 'S', 8));
+    cxxrtl::value<8> b{0x3u};
+
+    // Same inputs, same result
+    cxxrtl::value<8> first = a.add(b);
+    cxxrtl::value<8> second = a.add(b);
+    assert(first.node == second.node && first.ls == second.ls);
+    assert(stats.hits_ == 1 && stats.misses_ == 1);
+
+    // Concrete operations are never memoized
+    cxxrtl::value<8> concrete = b.add(b);
+    assert(concrete.data[0] == 0x6u);
+    assert(stats.misses_ == 1 && cxxrtl::op_memo::size() == 1);
+
+    // The concrete state is part of the key
+    b.data[0] = 0x4u;
+    [[maybe_unused]] cxxrtl::value<8> other = a.add(b);
+    assert(stats.misses_ == 2 && cxxrtl::op_memo::size() == 2);
+
+    // Memoized leaksets survive the end of the cycle
+    cxxrtl::op_memo::keep();
+    leaks::clear();
+    cxxrtl::value<8> third = a.add(cxxrtl::value<8>{0x3u});
+    assert(third.node == first.node && third.ls == first.ls);
+    assert(stats.hits_ == 2);
+
+    // The table is bounded, results are dropped once it is full and unused entries are evicted
+    cxxrtl::value<8> x = a.bit_xor(first);
+    x = x.bit_and(first).bit_or(a).bit_not();
+    assert(cxxrtl::op_memo::size() == 4 && stats.dropped_ > 0);
+    cxxrtl::op_memo::keep();
+    assert(stats.evicted_ > 0 && cxxrtl::op_memo::size() < 4);
+    leaks::clear();
+
+    // A register holding its node keeps its leakset through commits, cells it feeds are memoized
+    Observer observer;
+    cxxrtl::wire<8> reg;
+    for (int cycle = 0; cycle < 3; ++cycle) {
+        reg.next.setNode(a.node);
+        reg.commit(observer);
+        reg.symb_keep(false);
+        cxxrtl::op_memo::keep();
+        leaks::clear();
+    }
+    cxxrtl::value<8> fed = reg.curr.add(b);
+    unsigned int hits = stats.hits_;
+    reg.next.setNode(a.node);
+    reg.commit(observer);
+    reg.symb_keep(false);
+    cxxrtl::op_memo::keep();
+    leaks::clear();
+    cxxrtl::value<8> refed = reg.curr.add(b);
+    assert(stats.hits_ == hits + 1 && refed.node == fed.node && refed.ls == fed.ls);
+
+    std::cout << "Hits: " << stats.hits_ << ", misses: " << stats.misses_ << std::endl;
+    cxxrtl::op_memo::enable(0);
+    assert(cxxrtl::op_memo::size() == 0);
+
+    verifMSICleanup();
+}
@@ -131,5 +131,31 @@ int main(int argc, char *argv[]) {
     g = a.repeat<64>();
     assert(stability(g) == 0xFFFFFFFFFFFFFFFFull);
     std::cout << "Repeat stable to 64 bits g: " << stability(g) << std::endl;
+
+    // Concatenation keeps the bits and the stability of both parts
+    c = cxxrtl::value<33>{0x80000001u, 0x1u};
+    c.stability[0] = 0x0000F00Fu;
+    c.stability[1] = 0x1u;
+    d = cxxrtl::value<25>{0x1FFFFFEu};
+    d.stability[0] = 0x00FF00FFu;
+    cxxrtl::value<58> h = c.concat(d).val();
+    assert(h.data[0] == 0x03FFFFFEu && h.data[1] == 0x03000000u);
+    assert(stability(h) == 0x020001E01EFF00FFull);
+    std::cout << "Concat c, d: " << stability(h) << std::endl;
+    assert(h.node->nature == CONST && h.ls == nullptr);
+
+    // Slices and concatenations of symbolic values take the known slices of their parts
+    cxxrtl::value<8> x;
+    x.setNode(&symbol("x", 'S', 8));
+    cxxrtl::value<4> y;
+    y.setNode(&symbol("y", 'S', 4));
+    cxxrtl::value<12> xy = x.concat(y).val();
+    assert(leaks::bit(xy.node, 4) == leaks::bit(x.node, 0) && leaks::bit(xy.node, 3) == leaks::bit(y.node, 3));
+    assert(xy.ls->leaks.size() == 12 && xy.ls->leaks[11] == x.ls->leaks[7]);
+    cxxrtl::value<1> msb = xy.slice<11>().val();
+    assert(msb.node == leaks::bit(x.node, 7) && msb.ls->leaks[0] == x.ls->leaks[7]);
+    cxxrtl::value<6> middle = xy.slice<7, 2>().val();
+    assert(leaks::bit(middle.node, 2) == leaks::bit(x.node, 0));
+
     verifMSICleanup();
 }
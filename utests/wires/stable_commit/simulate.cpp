@@ -0,0 +1,50 @@
+#include <iostream>
+#include "cxxrtl/cxxrtl.h"
+#include "verif_msi_pp.hpp"
+#include "lss.h"
+
+// Global to cxxrtl, must be defined but will produce no logs here
+std::ofstream simulation_logger;
+
+struct Observer {
+    void on_update(size_t, const cxxrtl::chunk_t*, const cxxrtl::chunk_t*) {}
+    void on_update(size_t, const cxxrtl::chunk_t*, const cxxrtl::chunk_t*, size_t) {}
+};
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) {
+    Observer observer;
+    Node* a = &symbol("a", 'S', 4);
+    cxxrtl::wire<4> reg;
+    reg.next.setNode(a);
+    reg.commit(observer);
+    reg.symb_keep(false);
+    leaks::clear();
+
+    // A register holding its node commits the same leakset, which stays pinned. Its next value
+    // is cleared by symb_keep() and evaluated again each cycle.
+    reg.next.setNode(a);
+    reg.commit(observer);
+    leaks::LeakSet* pinned = reg.curr.ls;
+    assert(pinned != nullptr && pinned->pins_ == 0);
+    reg.symb_keep(false);
+    leaks::clear();
+    for (int cycle = 0; cycle < 2; ++cycle) {
+        reg.next.setNode(a);
+        reg.commit(observer);
+        assert(reg.curr.ls == pinned && reg.pinned == pinned);
+        reg.symb_keep(false);
+        leaks::clear();
+        assert(pinned->pins_ == 1 && leaks::LeakSet::ls_mem_.size() == 1);
+    }
+
+    // A new node is committed with a new leakset
+    reg.next.setNode(&symbol("b", 'S', 4));
+    reg.commit(observer);
+    assert(reg.curr.ls != pinned);
+    reg.symb_keep(false);
+    leaks::clear();
+    assert(reg.pinned == reg.curr.ls && leaks::LeakSet::ls_mem_.size() == 1);
+
+    std::cout << "Stable registers keep their leakset" << std::endl;
+    verifMSICleanup();
+}
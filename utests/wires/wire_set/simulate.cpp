@@ -0,0 +1,47 @@
+#include <cassert>
+#include <vector>
+#include "wire_set.h"
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) {
+    // Sizes that are not a multiple of the word size
+    WireSet a(130);
+    WireSet b(130);
+    assert(a.size() == 0);
+
+    a.insert(0);
+    a.insert(63);
+    a.insert(64);
+    a.insert(129);
+    assert(a.size() == 4);
+    assert(a.contains(63) && a.contains(64) && not a.contains(65));
+
+    a.erase(63);
+    assert(not a.contains(63) && a.size() == 3);
+
+    // Union
+    std::vector<WireId> ids{1, 64, 100};
+    b.insert(ids.cbegin(), ids.cend());
+    a |= b;
+    assert(a.size() == 5);
+
+    // Iteration is in identifier order and stops at the limit
+    std::vector<WireId> visited;
+    a.for_each(130, [&](WireId wire) { visited.push_back(wire); });
+    assert((visited == std::vector<WireId>{0, 1, 64, 100, 129}));
+
+    visited.clear();
+    a.for_each(100, [&](WireId wire) { visited.push_back(wire); });
+    assert((visited == std::vector<WireId>{0, 1, 64}));
+
+    // Fill below a bound
+    WireSet c(130);
+    c.insert_below(70);
+    assert(c.size() == 70 && c.contains(69) && not c.contains(70));
+    c.insert_below(128);
+    assert(c.size() == 128 && not c.contains(128));
+
+    c.clear();
+    assert(c.size() == 0);
+
+    return 0;
+}